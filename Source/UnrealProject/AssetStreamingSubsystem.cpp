@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AssetStreamingSubsystem.h"
+#include "UnrealProject.h"
+#include "Engine/GameInstance.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "UObject/UObjectGlobals.h"
+
+UAssetStreamingSubsystem::UAssetStreamingSubsystem()
+{
+	NumResidentAssets = 0;
+	ResidentMemoryBytes = 0;
+	NumFirstUseHitches = 0;
+	TotalHitchTimeMs = 0.f;
+	WorstHitchTimeMs = 0.f;
+}
+
+UAssetStreamingSubsystem* UAssetStreamingSubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UAssetStreamingSubsystem>() : nullptr;
+}
+
+void UAssetStreamingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &UAssetStreamingSubsystem::OnPreLoadMap);
+}
+
+void UAssetStreamingSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+
+	ResidentAssets.Empty();
+	PendingAssets.Empty();
+
+	Super::Deinitialize();
+}
+
+void UAssetStreamingSubsystem::Preload(const TArray<FSoftObjectPath>& Assets)
+{
+	TArray<FSoftObjectPath> ToLoad;
+	for (const FSoftObjectPath& Asset : Assets)
+	{
+		if (Asset.IsNull() || PendingAssets.Contains(Asset)) { continue; }
+
+		UObject* Loaded = Asset.ResolveObject();
+		if (Loaded)
+		{
+			AddResident(Loaded);
+			continue;
+		}
+		PendingAssets.Add(Asset);
+		ToLoad.Add(Asset);
+	}
+	if (ToLoad.Num() == 0) { return; }
+
+	UAssetManager::GetStreamableManager().RequestAsyncLoad(ToLoad, FStreamableDelegate::CreateUObject(this, &UAssetStreamingSubsystem::OnPreloadFinished, ToLoad));
+}
+
+UObject* UAssetStreamingSubsystem::LoadNow(const FSoftObjectPath& Asset)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	UObject* Loaded = UAssetManager::GetStreamableManager().LoadSynchronous(Asset);
+	const float HitchTimeMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	++NumFirstUseHitches;
+	TotalHitchTimeMs += HitchTimeMs;
+	WorstHitchTimeMs = FMath::Max(WorstHitchTimeMs, HitchTimeMs);
+	UE_LOG(LogUnrealProject, Verbose, TEXT("%s was loaded on first use, %.1f ms%s"), *Asset.ToString(), HitchTimeMs, PendingAssets.Contains(Asset) ? TEXT(" before its preload finished") : TEXT(""));
+
+	PendingAssets.Remove(Asset);
+	AddResident(Loaded);
+	return Loaded;
+}
+
+void UAssetStreamingSubsystem::OnPreloadFinished(TArray<FSoftObjectPath> Assets)
+{
+	for (const FSoftObjectPath& Asset : Assets)
+	{
+		// Assets requested before the last map change are not wanted anymore
+		if (PendingAssets.Remove(Asset) > 0)
+		{
+			AddResident(Asset.ResolveObject());
+		}
+	}
+}
+
+void UAssetStreamingSubsystem::AddResident(UObject* Asset)
+{
+	if (Asset == nullptr) { return; }
+
+	bool bAlreadyResident = false;
+	ResidentAssets.Add(Asset, &bAlreadyResident);
+	if (bAlreadyResident) { return; }
+
+	ResidentMemoryBytes += Asset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+	NumResidentAssets = ResidentAssets.Num();
+}
+
+void UAssetStreamingSubsystem::OnPreLoadMap(const FString& MapName)
+{
+	// The new map's actors preload what they need, the last map's assets go with the garbage collection of the map change
+	ResidentAssets.Empty();
+	PendingAssets.Empty();
+	NumResidentAssets = 0;
+	ResidentMemoryBytes = 0;
+}
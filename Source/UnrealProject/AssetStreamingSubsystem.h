@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "AssetStreamingSubsystem.generated.h"
+
+/**
+ * Loads the soft referenced combat and item assets before they are first used.
+ * Enemies request theirs when they aggro and items when the player comes near, so hits, swings and pickups
+ * find them in memory. Anything used before it arrived is loaded on the spot and counted as a hitch.
+ * Loaded assets stay resident until the next map starts loading.
+ */
+UCLASS()
+class UNREALPROJECT_API UAssetStreamingSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UAssetStreamingSubsystem();
+
+	static UAssetStreamingSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Assets loaded for the current map */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Asset Streaming | Stats")
+	int32 NumResidentAssets;
+
+	/** Estimated memory of the assets loaded for the current map */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Asset Streaming | Stats")
+	int64 ResidentMemoryBytes;
+
+	/** Assets that were used before their preload had finished, or without one */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Asset Streaming | Stats")
+	int32 NumFirstUseHitches;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Asset Streaming | Stats")
+	float TotalHitchTimeMs;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Asset Streaming | Stats")
+	float WorstHitchTimeMs;
+
+	/** Start loading Assets in the background, null and already loaded ones are skipped */
+	void Preload(const TArray<FSoftObjectPath>& Assets);
+
+	/** Asset if it is loaded, otherwise it is loaded right away and the hitch is counted */
+	template<class T>
+	static T* Resolve(const UObject* WorldContextObject, const TSoftObjectPtr<T>& Asset)
+	{
+		if (Asset.IsNull()) { return nullptr; }
+
+		T* Loaded = Asset.Get();
+		if (Loaded) { return Loaded; }
+
+		UAssetStreamingSubsystem* AssetStreamingSubsystem = Get(WorldContextObject);
+		return AssetStreamingSubsystem ? Cast<T>(AssetStreamingSubsystem->LoadNow(Asset.ToSoftObjectPath())) : Asset.LoadSynchronous();
+	}
+
+private:
+	UObject* LoadNow(const FSoftObjectPath& Asset);
+
+	void OnPreloadFinished(TArray<FSoftObjectPath> Assets);
+
+	void AddResident(UObject* Asset);
+
+	void OnPreLoadMap(const FString& MapName);
+
+	/** Keeps the loaded assets from being collected while the map is played */
+	UPROPERTY()
+	TSet<UObject*> ResidentAssets;
+
+	/** Assets requested and not in memory yet */
+	TSet<FSoftObjectPath> PendingAssets;
+
+	FDelegateHandle PreLoadMapHandle;
+};
@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BatchTickManager.h"
+#include "WorldManagers.h"
+#include "Item.h"
+#include "FloatingPlatform.h"
+#include "Critter.h"
+#include "Async/ParallelFor.h"
+
+// Sets default values
+ABatchTickManager::ABatchTickManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	bParallelUpdate = true;
+	MinParallelBatchSize = 512;
+
+	NumItems = 0;
+	NumPlatforms = 0;
+	NumCritters = 0;
+	UpdateTimeMs = 0.f;
+}
+
+ABatchTickManager* ABatchTickManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<ABatchTickManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+bool ABatchTickManager::CanBatchTick(const AActor* Actor)
+{
+	return Actor && !Actor->GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AActor, ReceiveTick));
+}
+
+// Called every frame
+void ABatchTickManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double StartTime = FPlatformTime::Seconds();
+	UpdateItems(DeltaTime);
+	UpdatePlatforms(DeltaTime);
+	UpdateCritters(DeltaTime);
+	UpdateTimeMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void ABatchTickManager::RegisterItem(AItem* Item)
+{
+	if (Item == nullptr || Item->BatchTickId != INDEX_NONE) { return; }
+
+	Item->BatchTickId = Items.Add(Item);
+	ItemBatch.Rotations.Add(Item->GetActorRotation());
+	ItemBatch.RotationRates.Add(Item->RotationRate);
+	NumItems = Items.Num();
+}
+
+void ABatchTickManager::UnregisterItem(AItem* Item)
+{
+	if (Item == nullptr || !Items.IsValidIndex(Item->BatchTickId) || Items[Item->BatchTickId] != Item) { return; }
+
+	const int32 Id = Item->BatchTickId;
+	Items.RemoveAtSwap(Id);
+	ItemBatch.Rotations.RemoveAtSwap(Id);
+	ItemBatch.RotationRates.RemoveAtSwap(Id);
+	if (Items.IsValidIndex(Id))
+	{
+		Items[Id]->BatchTickId = Id;
+	}
+	Item->BatchTickId = INDEX_NONE;
+	NumItems = Items.Num();
+}
+
+void ABatchTickManager::RegisterPlatform(AFloatingPlatform* Platform)
+{
+	if (Platform == nullptr || Platform->BatchTickId != INDEX_NONE) { return; }
+
+	Platform->BatchTickId = Platforms.Add(Platform);
+	PlatformBatch.Motions.Add(Platform->Motion);
+	PlatformBatch.Locations.Add(Platform->GetActorLocation());
+	PlatformBatch.Moving.Add(Platform->bInterping);
+	PlatformBatch.WasMoving.Add(Platform->bInterping);
+	NumPlatforms = Platforms.Num();
+}
+
+void ABatchTickManager::UnregisterPlatform(AFloatingPlatform* Platform)
+{
+	if (Platform == nullptr || !Platforms.IsValidIndex(Platform->BatchTickId) || Platforms[Platform->BatchTickId] != Platform) { return; }
+
+	const int32 Id = Platform->BatchTickId;
+	Platforms.RemoveAtSwap(Id);
+	PlatformBatch.Motions.RemoveAtSwap(Id);
+	PlatformBatch.Locations.RemoveAtSwap(Id);
+	PlatformBatch.Moving.RemoveAtSwap(Id);
+	PlatformBatch.WasMoving.RemoveAtSwap(Id);
+	if (Platforms.IsValidIndex(Id))
+	{
+		Platforms[Id]->BatchTickId = Id;
+	}
+	Platform->BatchTickId = INDEX_NONE;
+	NumPlatforms = Platforms.Num();
+}
+
+void ABatchTickManager::RegisterCritter(ACritter* Critter)
+{
+	if (Critter == nullptr || Critter->BatchTickId != INDEX_NONE) { return; }
+
+	Critter->BatchTickId = Critters.Add(Critter);
+	CritterBatch.Locations.Add(Critter->GetActorLocation());
+	CritterBatch.Velocities.Add(FVector::ZeroVector);
+	NumCritters = Critters.Num();
+}
+
+void ABatchTickManager::UnregisterCritter(ACritter* Critter)
+{
+	if (Critter == nullptr || !Critters.IsValidIndex(Critter->BatchTickId) || Critters[Critter->BatchTickId] != Critter) { return; }
+
+	const int32 Id = Critter->BatchTickId;
+	Critters.RemoveAtSwap(Id);
+	CritterBatch.Locations.RemoveAtSwap(Id);
+	CritterBatch.Velocities.RemoveAtSwap(Id);
+	if (Critters.IsValidIndex(Id))
+	{
+		Critters[Id]->BatchTickId = Id;
+	}
+	Critter->BatchTickId = INDEX_NONE;
+	NumCritters = Critters.Num();
+}
+
+void ABatchTickManager::SetCritterVelocity(const ACritter* Critter, const FVector& Velocity)
+{
+	if (Critter == nullptr || !Critters.IsValidIndex(Critter->BatchTickId)) { return; }
+
+	const int32 Id = Critter->BatchTickId;
+
+	// A critter standing still may have been moved by something else meanwhile
+	if (CritterBatch.Velocities[Id].IsZero())
+	{
+		CritterBatch.Locations[Id] = Critter->GetActorLocation();
+	}
+	CritterBatch.Velocities[Id] = Velocity;
+}
+
+bool ABatchTickManager::IsSingleThreaded(int32 Num) const
+{
+	return !bParallelUpdate || Num < MinParallelBatchSize;
+}
+
+void ABatchTickManager::UpdateItems(float DeltaTime)
+{
+	FItemBatch& Batch = ItemBatch;
+	ParallelFor(Batch.Num(), [&Batch, DeltaTime](int32 i)
+	{
+		FRotator& Rotation = Batch.Rotations[i];
+		Rotation.Yaw = FRotator::ClampAxis(Rotation.Yaw + DeltaTime * Batch.RotationRates[i]);
+	}, IsSingleThreaded(Batch.Num()));
+
+	for (int32 i = 0; i < Items.Num(); i++)
+	{
+		AItem* Item = Items[i];
+		Item->SetActorRotation(Batch.Rotations[i]);
+		Batch.RotationRates[i] = Item->RotationRate;
+	}
+}
+
+void ABatchTickManager::UpdatePlatforms(float DeltaTime)
+{
+	if (PlatformBatch.Num() == 0) { return; }
+
+	FPlatformBatch& Batch = PlatformBatch;
+	const float Time = AFloatingPlatform::GetMotionTime(GetWorld());
+	ParallelFor(Batch.Num(), [&Batch, Time](int32 i)
+	{
+		bool bMoving = false;
+		Batch.Locations[i] = Batch.Motions[i].Evaluate(Time, bMoving);
+		Batch.Moving[i] = bMoving;
+	}, IsSingleThreaded(Batch.Num()));
+
+	// Waiting platforms don't change, only moving ones and the ones that just arrived are written back
+	for (int32 i = 0; i < Platforms.Num(); i++)
+	{
+		if (!Batch.Moving[i] && !Batch.WasMoving[i]) { continue; }
+
+		AFloatingPlatform* Platform = Platforms[i];
+		Platform->SetActorLocation(Batch.Locations[i]);
+		Platform->bInterping = Batch.Moving[i];
+		Batch.WasMoving[i] = Batch.Moving[i];
+	}
+}
+
+void ABatchTickManager::UpdateCritters(float DeltaTime)
+{
+	FCritterBatch& Batch = CritterBatch;
+	ParallelFor(Batch.Num(), [&Batch, DeltaTime](int32 i)
+	{
+		Batch.Locations[i] += Batch.Velocities[i] * DeltaTime;
+	}, IsSingleThreaded(Batch.Num()));
+
+	// Critters nobody is steering don't move, only the moving ones need their transform updated
+	for (int32 i = 0; i < Critters.Num(); i++)
+	{
+		if (!Batch.Velocities[i].IsZero())
+		{
+			Critters[i]->SetActorLocation(Batch.Locations[i]);
+		}
+	}
+}
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "FloatingPlatform.h"
+#include "BatchTickManager.generated.h"
+
+/** Rotating items, stored as parallel arrays */
+struct FItemBatch
+{
+	TArray<FRotator> Rotations;
+	TArray<float> RotationRates;
+
+	int32 Num() const { return Rotations.Num(); }
+};
+
+/** Floating platforms, located from their motion and the current time alone, stored as parallel arrays */
+struct FPlatformBatch
+{
+	TArray<FPlatformMotion> Motions;
+
+	/** Written by the update, read back on the game thread */
+	TArray<FVector> Locations;
+	TArray<bool> Moving;
+
+	/** Moving last frame, a platform that just arrived still has to be put on its end point */
+	TArray<bool> WasMoving;
+
+	int32 Num() const { return Motions.Num(); }
+};
+
+/** Critters moving at the velocity their input gave them, stored as parallel arrays */
+struct FCritterBatch
+{
+	TArray<FVector> Locations;
+	TArray<FVector> Velocities;
+
+	int32 Num() const { return Locations.Num(); }
+};
+
+/**
+ * Moves rotating items, floating platforms and critters in one tick instead of one tick per actor.
+ * The data each of them needs is kept in contiguous arrays, updated in one loop per kind
+ * (split across worker threads for large batches) and then written back to the actors.
+ * Registered actors switch their own tick off, actors with a Blueprint Event Tick keep ticking themselves.
+ * Only rotating items are registered, AItem::SetRotate moves items in and out so the others cost nothing per frame.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API ABatchTickManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ABatchTickManager();
+
+	static ABatchTickManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** Update large batches on worker threads, writing the actors back always happens on the game thread */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Batch Tick")
+	bool bParallelUpdate;
+
+	/** Batches smaller than this are updated on the game thread, splitting them costs more than it saves */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Batch Tick")
+	int32 MinParallelBatchSize;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Batch Tick | Stats")
+	int32 NumItems;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Batch Tick | Stats")
+	int32 NumPlatforms;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Batch Tick | Stats")
+	int32 NumCritters;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Batch Tick | Stats")
+	float UpdateTimeMs;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	/** False for actors whose Blueprint implements Event Tick, their tick has to keep running */
+	static bool CanBatchTick(const AActor* Actor);
+
+	void RegisterItem(class AItem* Item);
+	void UnregisterItem(AItem* Item);
+
+	void RegisterPlatform(AFloatingPlatform* Platform);
+	void UnregisterPlatform(AFloatingPlatform* Platform);
+
+	void RegisterCritter(class ACritter* Critter);
+	void UnregisterCritter(ACritter* Critter);
+
+	/** Velocity the critter's input set, it keeps moving at it until set again */
+	void SetCritterVelocity(const ACritter* Critter, const FVector& Velocity);
+
+private:
+	void UpdateItems(float DeltaTime);
+
+	void UpdatePlatforms(float DeltaTime);
+
+	void UpdateCritters(float DeltaTime);
+
+	/** Whether a batch of Num is updated on the game thread only */
+	bool IsSingleThreaded(int32 Num) const;
+
+	/** Actors of each batch, in the same order as their data, each one's BatchTickId is its index */
+	UPROPERTY()
+	TArray<AItem*> Items;
+
+	UPROPERTY()
+	TArray<AFloatingPlatform*> Platforms;
+
+	UPROPERTY()
+	TArray<ACritter*> Critters;
+
+	FItemBatch ItemBatch;
+	FPlatformBatch PlatformBatch;
+	FCritterBatch CritterBatch;
+};
@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CheckpointSubsystem.h"
+#include "MainCharacter.h"
+#include "Weapon.h"
+#include "WorldStateManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Animation/AnimInstance.h"
+
+UCheckpointSubsystem::UCheckpointSubsystem()
+{
+	MaxCheckpoints = 4;
+
+	NextCheckpoint = 0;
+}
+
+UCheckpointSubsystem* UCheckpointSubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UCheckpointSubsystem>() : nullptr;
+}
+
+void UCheckpointSubsystem::CaptureCheckpoint(AMainCharacter* MainCharacter)
+{
+	if (MainCharacter == nullptr || MaxCheckpoints <= 0) { return; }
+	if (MainCharacter->MovementStatus == EMovementStatus::EMS_Dead) { return; }
+
+	UWorld* World = MainCharacter->GetWorld();
+
+	FCheckpoint Checkpoint;
+	FCharacterStats& Stats = Checkpoint.CharacterStats;
+	Stats.Health = MainCharacter->Health;
+	Stats.MaxHealth = MainCharacter->MaxHealth;
+	Stats.Stamina = MainCharacter->Stamina;
+	Stats.MaxStamina = MainCharacter->MaxStamina;
+	Stats.Coins = MainCharacter->Coins;
+	Stats.PlayTime = MainCharacter->PlayTime;
+
+	AWeapon* Weapon = MainCharacter->EquippedWeapon ? MainCharacter->EquippedWeapon : MainCharacter->UnequippedWeapon;
+	if (Weapon)
+	{
+		Stats.WeaponName = Weapon->Name;
+		Checkpoint.WeaponClass = Weapon->GetClass();
+	}
+
+	FString MapName = World->GetMapName();
+	MapName.RemoveFromStart(World->StreamingLevelsPrefix);
+	Stats.LevelName = MapName;
+
+	Stats.Location = MainCharacter->GetActorLocation();
+	Stats.Rotation = MainCharacter->GetActorRotation();
+
+	AWorldStateManager* WorldStateManager = AWorldStateManager::Get(MainCharacter, false);
+	if (WorldStateManager)
+	{
+		Checkpoint.WorldChangedBits = WorldStateManager->GetChangedBitsSnapshot();
+		Checkpoint.BaselineChecksum = WorldStateManager->GetBaselineChecksum();
+	}
+
+	if (NextCheckpoint >= MaxCheckpoints)
+	{
+		NextCheckpoint = 0;
+	}
+	if (Checkpoints.IsValidIndex(NextCheckpoint))
+	{
+		Checkpoints[NextCheckpoint] = MoveTemp(Checkpoint);
+	}
+	else
+	{
+		Checkpoints.Add(MoveTemp(Checkpoint));
+	}
+	NextCheckpoint = (NextCheckpoint + 1) % MaxCheckpoints;
+}
+
+bool UCheckpointSubsystem::RestoreCheckpoint(AMainCharacter* MainCharacter)
+{
+	if (MainCharacter == nullptr) { return false; }
+
+	UWorld* World = MainCharacter->GetWorld();
+	FString MapName = World->GetMapName();
+	MapName.RemoveFromStart(World->StreamingLevelsPrefix);
+
+	const FCheckpoint* Checkpoint = FindNewestCheckpoint(MapName);
+	if (Checkpoint == nullptr) { return false; }
+
+	const FCharacterStats& Stats = Checkpoint->CharacterStats;
+	MainCharacter->Health = Stats.Health;
+	MainCharacter->MaxHealth = Stats.MaxHealth;
+	MainCharacter->Stamina = Stats.Stamina;
+	MainCharacter->MaxStamina = Stats.MaxStamina;
+	MainCharacter->Coins = Stats.Coins;
+
+	// Only spawn a weapon if the one carried now is a different one
+	AWeapon* Carried = MainCharacter->EquippedWeapon ? MainCharacter->EquippedWeapon : MainCharacter->UnequippedWeapon;
+	if (Checkpoint->WeaponClass && (Carried == nullptr || Carried->GetClass() != Checkpoint->WeaponClass))
+	{
+		AWeapon* WeaponToEquip = World->SpawnActor<AWeapon>(Checkpoint->WeaponClass);
+		if (WeaponToEquip)
+		{
+			WeaponToEquip->Equip(MainCharacter);
+		}
+	}
+
+	MainCharacter->SetActorLocationAndRotation(Stats.Location, Stats.Rotation, false, nullptr, ETeleportType::ResetPhysics);
+
+	UAnimInstance* AnimInstance = MainCharacter->GetMesh()->GetAnimInstance();
+	if (AnimInstance)
+	{
+		AnimInstance->StopAllMontages(0.f);
+	}
+	MainCharacter->SetMovementStatus(EMovementStatus::EMS_Normal);
+	MainCharacter->GetMesh()->bPauseAnims = false;
+	MainCharacter->GetMesh()->bNoSkeletonUpdate = false;
+
+	AWorldStateManager* WorldStateManager = AWorldStateManager::Get(MainCharacter, false);
+	if (WorldStateManager && Checkpoint->WorldChangedBits.IsValid() && Checkpoint->BaselineChecksum == WorldStateManager->GetBaselineChecksum())
+	{
+		WorldStateManager->RestoreChangedBits(*Checkpoint->WorldChangedBits);
+	}
+
+	return true;
+}
+
+const FCheckpoint* UCheckpointSubsystem::FindNewestCheckpoint(const FString& LevelName) const
+{
+	// Walk back from the newest, NextCheckpoint - 1 in ring order
+	const int32 Num = Checkpoints.Num();
+	for (int32 i = 0; i < Num; i++)
+	{
+		const FCheckpoint& Checkpoint = Checkpoints[(NextCheckpoint - 1 - i + 2 * Num) % Num];
+		if (Checkpoint.CharacterStats.LevelName == LevelName)
+		{
+			return &Checkpoint;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "FirstSaveGame.h"
+#include "CheckpointSubsystem.generated.h"
+
+/** Character and level state at one checkpoint */
+USTRUCT()
+struct FCheckpoint
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FCharacterStats CharacterStats;
+
+	/** Resolved class of the carried weapon, restoring needs no weapon lookup */
+	UPROPERTY()
+	TSubclassOf<class AWeapon> WeaponClass;
+
+	/** World state changed bits, shared with neighbouring checkpoints while the level doesn't change */
+	TSharedPtr<const TBitArray<>> WorldChangedBits;
+
+	uint32 BaselineChecksum;
+
+	FCheckpoint()
+	{
+		WeaponClass = nullptr;
+		BaselineChecksum = 0;
+	}
+};
+
+/**
+ * Keeps the last few checkpoints in memory so the player can respawn without reading a save or reloading the level.
+ * Checkpoints are taken when a level starts and when a floor switch is stepped on.
+ */
+UCLASS()
+class UNREALPROJECT_API UCheckpointSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UCheckpointSubsystem();
+
+	static UCheckpointSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Checkpoints kept, the oldest is overwritten */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Checkpoint")
+	int32 MaxCheckpoints;
+
+	void CaptureCheckpoint(class AMainCharacter* MainCharacter);
+
+	/** Put MainCharacter back to the newest checkpoint of the current level, false if there is none */
+	bool RestoreCheckpoint(AMainCharacter* MainCharacter);
+
+	int32 GetNumCheckpoints() const { return Checkpoints.Num(); }
+
+private:
+	/** Newest checkpoint taken in LevelName, null if the ring holds none */
+	const FCheckpoint* FindNewestCheckpoint(const FString& LevelName) const;
+
+	/** Ring of checkpoints, NextCheckpoint is where the next one goes */
+	UPROPERTY()
+	TArray<FCheckpoint> Checkpoints;
+
+	int32 NextCheckpoint;
+};
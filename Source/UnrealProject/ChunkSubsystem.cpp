@@ -0,0 +1,260 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChunkSubsystem.h"
+#include "UnrealProject.h"
+#include "Engine/GameInstance.h"
+#include "Kismet/GameplayStatics.h"
+#include "AssetRegistryModule.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+UChunkSubsystem::UChunkSubsystem()
+{
+	NumMountedChunks = 0;
+	LastDownloadTimeMs = 0.f;
+	LastMountTimeMs = 0.f;
+	MountedPakMB = 0.f;
+	MountMemoryMB = 0.f;
+}
+
+UChunkSubsystem* UChunkSubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UChunkSubsystem>() : nullptr;
+}
+
+void UChunkSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ChunkSourceDirectory = FPaths::ProjectDir() / TEXT("ChunkSource");
+	FParse::Value(FCommandLine::Get(), TEXT("ChunkSource="), ChunkSourceDirectory);
+}
+
+void UChunkSubsystem::Deinitialize()
+{
+	// Copies still running write into the download directory, they must not outlive the subsystem
+	for (auto& Chunk : Chunks)
+	{
+		if (Chunk.Value.Download.IsValid())
+		{
+			Chunk.Value.Download.Wait();
+		}
+	}
+
+	Super::Deinitialize();
+}
+
+bool UChunkSubsystem::AreMapChunksMounted(FName MapPackage)
+{
+	return GetMissingChunks(MapPackage).Num() == 0;
+}
+
+void UChunkSubsystem::MountMapChunks(FName MapPackage, FOnChunksMounted OnMounted)
+{
+	FPendingChunkMount& Pending = PendingMounts.AddDefaulted_GetRef();
+	Pending.ChunkIds = GetMissingChunks(MapPackage);
+	Pending.OnMounted = OnMounted;
+
+	for (int32 ChunkId : Pending.ChunkIds)
+	{
+		RequestChunk(ChunkId);
+	}
+
+	NotifyPendingMounts();
+}
+
+bool UChunkSubsystem::MountMapChunksNow(FName MapPackage)
+{
+	bool bSuccess = true;
+	for (int32 ChunkId : GetMissingChunks(MapPackage))
+	{
+		RequestChunk(ChunkId);
+
+		FPakChunk& Chunk = Chunks.FindChecked(ChunkId);
+		if (Chunk.State == EPakChunkState::Downloading)
+		{
+			// The game thread task queued by the copy finds the chunk mounted already and does nothing
+			OnDownloadFinished(ChunkId, Chunk.Download.Get());
+		}
+		bSuccess &= Chunk.State == EPakChunkState::Mounted;
+	}
+	return bSuccess;
+}
+
+TArray<int32> UChunkSubsystem::GetMissingChunks(FName MapPackage)
+{
+	TArray<int32> Missing;
+	if (MapPackage.IsNone()) { return Missing; }
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssetsByPackageName(MapPackage, Assets);
+	for (const FAssetData& Asset : Assets)
+	{
+		for (int32 ChunkId : Asset.ChunkIDs)
+		{
+			// Chunk 0 is mounted with the game
+			if (ChunkId == 0) { continue; }
+
+			const FPakChunk* Chunk = Chunks.Find(ChunkId);
+			if (Chunk && Chunk->State == EPakChunkState::Mounted) { continue; }
+
+			Missing.AddUnique(ChunkId);
+		}
+	}
+
+	// Paks left in Content/Paks are mounted at startup and the editor loads loose files, either way there is nothing to fetch
+	if (Missing.Num() > 0 && FPackageName::DoesPackageExist(MapPackage.ToString()))
+	{
+		for (int32 ChunkId : Missing)
+		{
+			if (!Chunks.Contains(ChunkId))
+			{
+				Chunks.Add(ChunkId).State = EPakChunkState::Mounted;
+			}
+		}
+		Missing.RemoveAll([this](int32 ChunkId) { return Chunks.FindChecked(ChunkId).State == EPakChunkState::Mounted; });
+	}
+	return Missing;
+}
+
+void UChunkSubsystem::RequestChunk(int32 ChunkId)
+{
+	FPakChunk& Chunk = Chunks.FindOrAdd(ChunkId);
+
+	// A failed chunk is tried again, the source may have it by now
+	if (Chunk.State == EPakChunkState::Downloading || Chunk.State == EPakChunkState::Mounted) { return; }
+
+	const FString SourcePath = FindSourcePak(ChunkId);
+	if (SourcePath.IsEmpty())
+	{
+		UE_LOG(LogUnrealProject, Warning, TEXT("Chunk %d: no pak in %s"), ChunkId, *ChunkSourceDirectory);
+		Chunk.State = EPakChunkState::Failed;
+		return;
+	}
+
+	Chunk.State = EPakChunkState::Downloading;
+	Chunk.PakPath = FPaths::ProjectPersistentDownloadDir() / TEXT("Chunks") / FPaths::GetCleanFilename(SourcePath);
+	Chunk.RequestTime = FPlatformTime::Seconds();
+
+	const FString PakPath = Chunk.PakPath;
+	TWeakObjectPtr<UChunkSubsystem> WeakThis(this);
+
+	Chunk.Download = Async(EAsyncExecution::ThreadPool, [SourcePath, PakPath, ChunkId, WeakThis]()
+	{
+		// A copy from an earlier session is reused as long as it is complete
+		IFileManager& FileManager = IFileManager::Get();
+		bool bSuccess = FileManager.FileSize(*PakPath) == FileManager.FileSize(*SourcePath);
+		if (!bSuccess)
+		{
+			const FString TempPath = PakPath + TEXT(".tmp");
+			bSuccess = FileManager.Copy(*TempPath, *SourcePath) == COPY_OK && FileManager.Move(*PakPath, *TempPath, true, true);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [ChunkId, bSuccess, WeakThis]()
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->OnDownloadFinished(ChunkId, bSuccess);
+			}
+		});
+
+		return bSuccess;
+	});
+}
+
+void UChunkSubsystem::OnDownloadFinished(int32 ChunkId, bool bSuccess)
+{
+	FPakChunk* Chunk = Chunks.Find(ChunkId);
+	if (Chunk == nullptr || Chunk->State != EPakChunkState::Downloading) { return; }
+
+	Chunk->DownloadTimeMs = (float)((FPlatformTime::Seconds() - Chunk->RequestTime) * 1000.0);
+	LastDownloadTimeMs = Chunk->DownloadTimeMs;
+
+	if (bSuccess)
+	{
+		MountChunk(ChunkId);
+	}
+	else
+	{
+		UE_LOG(LogUnrealProject, Warning, TEXT("Chunk %d: download to %s failed"), ChunkId, *Chunk->PakPath);
+		Chunk->State = EPakChunkState::Failed;
+	}
+
+	NotifyPendingMounts();
+}
+
+void UChunkSubsystem::MountChunk(int32 ChunkId)
+{
+	FPakChunk& Chunk = Chunks.FindChecked(ChunkId);
+
+	// Mounting loads the pak index, the memory it takes is what the chunk costs while mounted
+	const uint64 MemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Read order 0 like the paks mounted at startup, chunks never replace each other's files
+	const bool bMounted = FCoreDelegates::OnMountPak.IsBound() && FCoreDelegates::OnMountPak.Execute(Chunk.PakPath, 0, nullptr);
+
+	Chunk.MountTimeMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	LastMountTimeMs = Chunk.MountTimeMs;
+
+	if (!bMounted)
+	{
+		UE_LOG(LogUnrealProject, Warning, TEXT("Chunk %d: mounting %s failed"), ChunkId, *Chunk.PakPath);
+		Chunk.State = EPakChunkState::Failed;
+		return;
+	}
+
+	Chunk.State = EPakChunkState::Mounted;
+	Chunk.PakSizeBytes = IFileManager::Get().FileSize(*Chunk.PakPath);
+	Chunk.MountMemoryBytes = FMath::Max<int64>(0, (int64)FPlatformMemory::GetStats().UsedPhysical - (int64)MemoryBefore);
+
+	++NumMountedChunks;
+	MountedPakMB += (float)Chunk.PakSizeBytes / (1024.f * 1024.f);
+	MountMemoryMB += (float)Chunk.MountMemoryBytes / (1024.f * 1024.f);
+
+	UE_LOG(LogUnrealProject, Verbose, TEXT("Chunk %d: downloaded in %.1f ms, mounted in %.1f ms, %.1f MB pak, %.1f KB memory"),
+		ChunkId, Chunk.DownloadTimeMs, Chunk.MountTimeMs, Chunk.PakSizeBytes / (1024.f * 1024.f), Chunk.MountMemoryBytes / 1024.f);
+}
+
+void UChunkSubsystem::NotifyPendingMounts()
+{
+	TArray<TPair<FOnChunksMounted, bool>> Finished;
+	for (int32 i = PendingMounts.Num() - 1; i >= 0; i--)
+	{
+		bool bDone = true;
+		bool bSuccess = true;
+		for (int32 ChunkId : PendingMounts[i].ChunkIds)
+		{
+			const EPakChunkState State = Chunks.FindChecked(ChunkId).State;
+			bDone &= State == EPakChunkState::Mounted || State == EPakChunkState::Failed;
+			bSuccess &= State == EPakChunkState::Mounted;
+		}
+		if (!bDone) { continue; }
+
+		Finished.Emplace(PendingMounts[i].OnMounted, bSuccess);
+		PendingMounts.RemoveAt(i);
+	}
+
+	// Run once the list is settled, a callback may well ask for more chunks
+	for (TPair<FOnChunksMounted, bool>& Mount : Finished)
+	{
+		Mount.Key.ExecuteIfBound(Mount.Value);
+	}
+}
+
+FString UChunkSubsystem::FindSourcePak(int32 ChunkId) const
+{
+	// Named the way the cooker names chunk paks, pakchunk<Id>-<Platform>.pak
+	TArray<FString> Found;
+	IFileManager::Get().FindFiles(Found, *(ChunkSourceDirectory / FString::Printf(TEXT("pakchunk%d-*.pak"), ChunkId)), true, false);
+	return Found.Num() > 0 ? ChunkSourceDirectory / Found[0] : FString();
+}
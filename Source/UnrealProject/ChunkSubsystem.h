@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Async/Future.h"
+#include "ChunkSubsystem.generated.h"
+
+DECLARE_DELEGATE_OneParam(FOnChunksMounted, bool /* bSuccess */);
+
+enum class EPakChunkState : uint8
+{
+	NotMounted,
+	Downloading,
+	Mounted,
+	Failed
+};
+
+/** One pak chunk and what getting it mounted took */
+struct FPakChunk
+{
+	EPakChunkState State;
+
+	/** Where the chunk was downloaded to and mounted from */
+	FString PakPath;
+
+	TFuture<bool> Download;
+
+	double RequestTime;
+	float DownloadTimeMs;
+	float MountTimeMs;
+	int64 PakSizeBytes;
+
+	/** Physical memory taken by mounting, mostly the pak index */
+	int64 MountMemoryBytes;
+
+	FPakChunk()
+	{
+		State = EPakChunkState::NotMounted;
+		RequestTime = 0.0;
+		DownloadTimeMs = 0.f;
+		MountTimeMs = 0.f;
+		PakSizeBytes = 0;
+		MountMemoryBytes = 0;
+	}
+};
+
+/** Maps waiting for their chunks */
+struct FPendingChunkMount
+{
+	TArray<int32> ChunkIds;
+	FOnChunksMounted OnMounted;
+};
+
+/**
+ * Mounts the pak chunks of a map when the game is about to need it, instead of every pak at startup.
+ * Chunks are assigned per map in DefaultGame.ini, the map's chunk IDs are read from the cooked asset registry.
+ * Chunks missing from the paks mounted at startup are fetched from ChunkSourceDirectory, a local stand-in for a download
+ * server, copied on the thread pool to the persistent download directory and mounted on the game thread.
+ * Chunk 0 and anything already loadable, like loose files in the editor, count as mounted.
+ */
+UCLASS()
+class UNREALPROJECT_API UChunkSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UChunkSubsystem();
+
+	static UChunkSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Where chunk paks are fetched from, -ChunkSource= on the command line overrides it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+	FString ChunkSourceDirectory;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Chunks | Stats")
+	int32 NumMountedChunks;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Chunks | Stats")
+	float LastDownloadTimeMs;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Chunks | Stats")
+	float LastMountTimeMs;
+
+	/** Size of the paks mounted on demand */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Chunks | Stats")
+	float MountedPakMB;
+
+	/** Physical memory the on demand mounts took */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Chunks | Stats")
+	float MountMemoryMB;
+
+	bool AreMapChunksMounted(FName MapPackage);
+
+	/** Download and mount the chunks MapPackage is cooked into, OnMounted runs once all of them are done */
+	void MountMapChunks(FName MapPackage, FOnChunksMounted OnMounted);
+
+	/** Same, but returns once they are mounted, for a level that is opened right now */
+	bool MountMapChunksNow(FName MapPackage);
+
+private:
+	/** Chunks of MapPackage that aren't mounted yet */
+	TArray<int32> GetMissingChunks(FName MapPackage);
+
+	void RequestChunk(int32 ChunkId);
+
+	void OnDownloadFinished(int32 ChunkId, bool bSuccess);
+
+	void MountChunk(int32 ChunkId);
+
+	/** Run the callbacks of maps whose chunks are all done */
+	void NotifyPendingMounts();
+
+	FString FindSourcePak(int32 ChunkId) const;
+
+	TMap<int32, FPakChunk> Chunks;
+
+	TArray<FPendingChunkMount> PendingMounts;
+};
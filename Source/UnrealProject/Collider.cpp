@@ -6,7 +6,9 @@
 #include "Components/InputComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/SphereComponent.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Camera/CameraComponent.h"
 
@@ -25,14 +27,9 @@ ACollider::ACollider()
 
 	MeshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComponent"));
 	MeshComponent->SetupAttachment(GetRootComponent());
-	static ConstructorHelpers::FObjectFinder<UStaticMesh> MeshComponentAsset(TEXT("StaticMesh'/Game/StarterContent/Shapes/Shape_Sphere.Shape_Sphere'"));
-
-	if (MeshComponentAsset.Succeeded())
-	{
-		MeshComponent->SetStaticMesh(MeshComponentAsset.Object);
-		MeshComponent->SetRelativeLocation(FVector(0.f, 0.f, -40.f));
-		MeshComponent->SetWorldScale3D(FVector(0.8f));
-	}
+	MeshComponent->SetRelativeLocation(FVector(0.f, 0.f, -40.f));
+	MeshComponent->SetWorldScale3D(FVector(0.8f));
+	MeshAsset = FSoftObjectPath(TEXT("/Game/StarterContent/Shapes/Shape_Sphere.Shape_Sphere"));
 
 	SpringArm = CreateDefaultSubobject<USpringArmComponent>(TEXT("SpringArm"));
 	SpringArm->SetupAttachment(GetRootComponent());
@@ -56,7 +53,16 @@ ACollider::ACollider()
 void ACollider::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (!MeshAsset.IsNull() && MeshComponent->GetStaticMesh() == nullptr)
+	{
+		UAssetManager::GetStreamableManager().RequestAsyncLoad(MeshAsset.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &ACollider::OnMeshAssetLoaded));
+	}
+}
+
+void ACollider::OnMeshAssetLoaded()
+{
+	MeshComponent->SetStaticMesh(MeshAsset.Get());
 }
 
 // Called every frame
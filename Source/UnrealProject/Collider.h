@@ -29,6 +29,10 @@ public:
 	UPROPERTY(VisibleAnywhere, Category = "Mesh")
 	class UStaticMeshComponent* MeshComponent;
 
+	/** Loaded in the background when play begins rather than with the class */
+	UPROPERTY(EditDefaultsOnly, Category = "Mesh")
+	TSoftObjectPtr<class UStaticMesh> MeshAsset;
+
 	UPROPERTY(VisibleAnywhere, Category = "Mesh")
 	class USphereComponent* SphereComponent;
 
@@ -60,5 +64,7 @@ private:
 	void YawCamera(float AxisValue);
 	void PitchCamera(float AxisValue);
 
+	void OnMeshAssetLoaded();
+
 	FVector2D CameraInput;
 };
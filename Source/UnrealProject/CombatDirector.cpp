@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatDirector.h"
+#include "WorldManagers.h"
+#include "Enemy.h"
+#include "MainCharacter.h"
+
+// Sets default values
+ACombatDirector::ACombatDirector()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	MaxAttackersPerTarget = 2;
+	NumSurroundSlots = 8;
+	SlotRadius = 90.f;
+	SlotAcceptanceRadius = 30.f;
+	MaxAttackStartsPerFrame = 2;
+	RetryMinDelay = 0.2f;
+	RetryMaxDelay = 0.6f;
+
+	NumScheduledAttacks = 0;
+	NumActiveAttackers = 0;
+	NumAttacksStartedLastFrame = 0;
+}
+
+ACombatDirector* ACombatDirector::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<ACombatDirector>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called every frame
+void ACombatDirector::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	NumAttacksStartedLastFrame = 0;
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	while (Timeline.Num() > 0 && Timeline.HeapTop().Time <= Now && NumAttacksStartedLastFrame < MaxAttackStartsPerFrame)
+	{
+		FScheduledAttack Attack;
+		Timeline.HeapPop(Attack);
+
+		AEnemy* Enemy = Attack.Enemy.Get();
+		int32 Slot;
+		const int32 EngagementIndex = FindEngagement(Enemy, Slot);
+		if (EngagementIndex == INDEX_NONE || Slot == INDEX_NONE) { continue; }
+
+		FCombatEngagement* Engagement = &Engagements[EngagementIndex];
+		if (Engagement->TokenHolders.Num() >= MaxAttackersPerTarget)
+		{
+			Schedule(Enemy, FMath::RandRange(RetryMinDelay, RetryMaxDelay));
+			continue;
+		}
+
+		Engagement->TokenHolders.Add(Enemy);
+		Enemy->Attack();
+
+		// Attack() refuses when the enemy has no valid target or its montage can't play, hand the token back and try again later
+		if (Enemy->bAttacking)
+		{
+			++NumAttacksStartedLastFrame;
+		}
+		else
+		{
+			Engagement->TokenHolders.RemoveSwap(Enemy);
+			Schedule(Enemy, FMath::RandRange(RetryMinDelay, RetryMaxDelay));
+		}
+	}
+
+	NumActiveAttackers = 0;
+	for (int32 i = Engagements.Num() - 1; i >= 0; i--)
+	{
+		FCombatEngagement& Engagement = Engagements[i];
+		if (Engagement.Player == nullptr || Engagement.Player->IsPendingKill())
+		{
+			for (AEnemy* Enemy : Engagement.Slots)
+			{
+				Unschedule(Enemy);
+			}
+			Engagements.RemoveAtSwap(i);
+			continue;
+		}
+		NumActiveAttackers += Engagement.TokenHolders.Num();
+	}
+
+	NumScheduledAttacks = Timeline.Num();
+}
+
+void ACombatDirector::Engage(AEnemy* Enemy, AMainCharacter* Player)
+{
+	if (Enemy == nullptr || Player == nullptr) { return; }
+
+	Disengage(Enemy);
+
+	FCombatEngagement* Engagement = Engagements.FindByPredicate([Player](const FCombatEngagement& Candidate) { return Candidate.Player == Player; });
+	if (Engagement == nullptr)
+	{
+		Engagement = &Engagements.AddDefaulted_GetRef();
+		Engagement->Player = Player;
+	}
+	Engagement->Slots.SetNum(NumSurroundSlots);
+
+	if (ClaimSlot(*Engagement, Enemy))
+	{
+		Schedule(Enemy, FMath::RandRange(Enemy->AttackMinTime, Enemy->AttackMaxTime));
+	}
+	else
+	{
+		Engagement->Waiting.Add(Enemy);
+	}
+}
+
+void ACombatDirector::Disengage(AEnemy* Enemy)
+{
+	int32 Slot;
+	const int32 EngagementIndex = FindEngagement(Enemy, Slot);
+	if (EngagementIndex == INDEX_NONE) { return; }
+
+	FCombatEngagement* Engagement = &Engagements[EngagementIndex];
+
+	Unschedule(Enemy);
+	Engagement->TokenHolders.RemoveSwap(Enemy);
+	Engagement->Waiting.Remove(Enemy);
+
+	if (Slot != INDEX_NONE)
+	{
+		Engagement->Slots[Slot] = nullptr;
+
+		// First enemy in line takes the freed slot
+		while (Engagement->Waiting.Num() > 0)
+		{
+			AEnemy* Next = Engagement->Waiting[0];
+			Engagement->Waiting.RemoveAt(0);
+			if (IsValid(Next) && Next->Alive() && ClaimSlot(*Engagement, Next))
+			{
+				Schedule(Next, FMath::RandRange(Next->AttackMinTime, Next->AttackMaxTime));
+				break;
+			}
+		}
+	}
+}
+
+void ACombatDirector::AttackFinished(AEnemy* Enemy)
+{
+	int32 Slot;
+	const int32 EngagementIndex = FindEngagement(Enemy, Slot);
+	if (EngagementIndex == INDEX_NONE || Slot == INDEX_NONE) { return; }
+
+	Engagements[EngagementIndex].TokenHolders.RemoveSwap(Enemy);
+	Schedule(Enemy, FMath::RandRange(Enemy->AttackMinTime, Enemy->AttackMaxTime));
+}
+
+bool ACombatDirector::GetSlotLocation(const AEnemy* Enemy, FVector& OutLocation) const
+{
+	int32 Slot;
+	const int32 EngagementIndex = FindEngagement(Enemy, Slot);
+	if (EngagementIndex == INDEX_NONE || Slot == INDEX_NONE) { return false; }
+
+	const FCombatEngagement& Engagement = Engagements[EngagementIndex];
+	const float Angle = 2.f * PI * Slot / Engagement.Slots.Num();
+	OutLocation = Engagement.Player->GetActorLocation() + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * SlotRadius;
+	return true;
+}
+
+int32 ACombatDirector::FindEngagement(const AEnemy* Enemy, int32& OutSlot) const
+{
+	OutSlot = INDEX_NONE;
+	if (Enemy == nullptr) { return INDEX_NONE; }
+
+	for (int32 i = 0; i < Engagements.Num(); i++)
+	{
+		OutSlot = Engagements[i].Slots.Find(const_cast<AEnemy*>(Enemy));
+		if (OutSlot != INDEX_NONE || Engagements[i].Waiting.Contains(Enemy))
+		{
+			return i;
+		}
+	}
+	return INDEX_NONE;
+}
+
+bool ACombatDirector::ClaimSlot(FCombatEngagement& Engagement, AEnemy* Enemy)
+{
+	// Free slot closest to the side the enemy is already standing on
+	const FVector ToEnemy = Enemy->GetActorLocation() - Engagement.Player->GetActorLocation();
+	const float EnemyAngle = FMath::Atan2(ToEnemy.Y, ToEnemy.X);
+
+	int32 BestSlot = INDEX_NONE;
+	float BestDifference = MAX_flt;
+	for (int32 Slot = 0; Slot < Engagement.Slots.Num(); Slot++)
+	{
+		if (Engagement.Slots[Slot]) { continue; }
+
+		const float SlotAngle = 2.f * PI * Slot / Engagement.Slots.Num();
+		const float Difference = FMath::Abs(FMath::FindDeltaAngleRadians(EnemyAngle, SlotAngle));
+		if (Difference < BestDifference)
+		{
+			BestDifference = Difference;
+			BestSlot = Slot;
+		}
+	}
+
+	if (BestSlot == INDEX_NONE) { return false; }
+
+	Engagement.Slots[BestSlot] = Enemy;
+	return true;
+}
+
+void ACombatDirector::Schedule(AEnemy* Enemy, float Delay)
+{
+	Unschedule(Enemy);
+
+	FScheduledAttack Attack;
+	Attack.Time = GetWorld()->GetTimeSeconds() + Delay;
+	Attack.Enemy = Enemy;
+	Timeline.HeapPush(Attack);
+}
+
+void ACombatDirector::Unschedule(AEnemy* Enemy)
+{
+	if (Enemy == nullptr) { return; }
+
+	if (Timeline.RemoveAll([Enemy](const FScheduledAttack& Attack) { return Attack.Enemy == Enemy; }) > 0)
+	{
+		Timeline.Heapify();
+	}
+}
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CombatDirector.generated.h"
+
+/** Enemies engaging one player, each in a slot around them */
+USTRUCT()
+struct FCombatEngagement
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	class AMainCharacter* Player;
+
+	/** Enemy in each surround slot, null when the slot is free */
+	UPROPERTY()
+	TArray<class AEnemy*> Slots;
+
+	/** Enemies in combat range waiting for a slot to free up */
+	UPROPERTY()
+	TArray<AEnemy*> Waiting;
+
+	/** Enemies currently allowed to attack */
+	UPROPERTY()
+	TArray<AEnemy*> TokenHolders;
+};
+
+/**
+ * Decides when enemies in combat range get to attack.
+ * Each player has a ring of surround slots and a small number of attack tokens,
+ * attacks are started from a single timeline instead of a timer on every enemy,
+ * which bounds the attack montages and combat hitboxes active at once.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API ACombatDirector : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ACombatDirector();
+
+	static ACombatDirector* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** Enemies allowed to attack the same player at once */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat Director")
+	int32 MaxAttackersPerTarget;
+
+	/** Enemies that can stand around one player, more wait until a slot frees up */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat Director")
+	int32 NumSurroundSlots;
+
+	/** Distance of the surround slots from the player */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat Director")
+	float SlotRadius;
+
+	/** How close enemies walk to their slot before they stop */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat Director")
+	float SlotAcceptanceRadius;
+
+	/** Attacks started per frame across all players, the rest start on following frames */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat Director")
+	int32 MaxAttackStartsPerFrame;
+
+	/** Delay before an enemy that found no free token tries again */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat Director")
+	float RetryMinDelay;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat Director")
+	float RetryMaxDelay;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Director | Stats")
+	int32 NumScheduledAttacks;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Director | Stats")
+	int32 NumActiveAttackers;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Director | Stats")
+	int32 NumAttacksStartedLastFrame;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	/** Enemy reached Player's combat range, give it a slot and schedule its first attack */
+	void Engage(AEnemy* Enemy, AMainCharacter* Player);
+
+	/** Enemy left combat range, died or went away, frees its slot, token and scheduled attack */
+	void Disengage(AEnemy* Enemy);
+
+	/** Enemy's attack sequence ended, returns its token and schedules the next attack */
+	void AttackFinished(AEnemy* Enemy);
+
+	/** World location of the surround slot Enemy holds, false if it holds none */
+	bool GetSlotLocation(const AEnemy* Enemy, FVector& OutLocation) const;
+
+private:
+	struct FScheduledAttack
+	{
+		float Time;
+		TWeakObjectPtr<AEnemy> Enemy;
+
+		bool operator<(const FScheduledAttack& Other) const { return Time < Other.Time; }
+	};
+
+	/** Index of the engagement Enemy is part of, OutSlot is INDEX_NONE while it waits for a slot */
+	int32 FindEngagement(const AEnemy* Enemy, int32& OutSlot) const;
+
+	bool ClaimSlot(FCombatEngagement& Engagement, AEnemy* Enemy);
+
+	void Schedule(AEnemy* Enemy, float Delay);
+
+	void Unschedule(AEnemy* Enemy);
+
+	UPROPERTY()
+	TArray<FCombatEngagement> Engagements;
+
+	/** Pending attack starts, kept as a heap ordered by time */
+	TArray<FScheduledAttack> Timeline;
+};
@@ -0,0 +1,291 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatRangeManager.h"
+#include "WorldManagers.h"
+#include "Enemy.h"
+#include "MainCharacter.h"
+#include "Components/SphereComponent.h"
+#include "Components/CapsuleComponent.h"
+
+// Sets default values
+ACombatRangeManager::ACombatRangeManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	CellSize = 1000.f;
+
+	NumOccupiedCells = 0;
+	NumPairsInRange = 0;
+	NumEventsLastFrame = 0;
+
+	MaxRadius = 0.f;
+}
+
+ACombatRangeManager* ACombatRangeManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<ACombatRangeManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called every frame
+void ACombatRangeManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Re-bucket enemies that crossed a cell boundary since last frame
+	for (int32 i = Enemies.Num() - 1; i >= 0; i--)
+	{
+		AEnemy* Enemy = Enemies[i];
+		if (Enemy == nullptr || Enemy->IsPendingKill())
+		{
+			RemoveEnemyAt(i);
+			continue;
+		}
+
+		FIntPoint Cell = GetCell(Enemy->GetActorLocation());
+		if (Cell != EnemyCells[i])
+		{
+			MoveToCell(i, Cell);
+		}
+	}
+
+	TMap<FRangePair, uint8> PreviousRanges = MoveTemp(CurrentRanges);
+	CurrentRanges.Reset();
+
+	for (AMainCharacter* Player : Players)
+	{
+		if (Player == nullptr || Player->IsPendingKill()) { continue; }
+
+		const FVector PlayerLocation = Player->GetActorLocation();
+		const float PlayerRadius = Player->GetCapsuleComponent()->GetScaledCapsuleRadius();
+		const float PlayerHalfHeight = Player->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+		const FIntPoint PlayerCell = GetCell(PlayerLocation);
+
+		// Ranges are tested against the capsule's surface, so an enemy up to MaxRadius past it still counts
+		const int32 CellReach = FMath::Max(1, FMath::CeilToInt((MaxRadius + PlayerRadius) / CellSize));
+
+		for (int32 X = PlayerCell.X - CellReach; X <= PlayerCell.X + CellReach; X++)
+		{
+			for (int32 Y = PlayerCell.Y - CellReach; Y <= PlayerCell.Y + CellReach; Y++)
+			{
+				const TArray<int32>* CellEnemies = Cells.Find(FIntPoint(X, Y));
+				if (CellEnemies == nullptr) { continue; }
+
+				for (int32 EnemyIndex : *CellEnemies)
+				{
+					uint8 Flags = ComputeRangeFlags(EnemyIndex, PlayerLocation, PlayerRadius, PlayerHalfHeight);
+					if (Flags != 0)
+					{
+						CurrentRanges.Add(FRangePair(Enemies[EnemyIndex], Player), Flags);
+					}
+				}
+			}
+		}
+	}
+
+	NumOccupiedCells = Cells.Num();
+	NumPairsInRange = CurrentRanges.Num();
+
+	DispatchEvents(PreviousRanges);
+}
+
+void ACombatRangeManager::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || Enemies.Contains(Enemy)) { return; }
+
+	const FIntPoint Cell = GetCell(Enemy->GetActorLocation());
+
+	Enemies.Add(Enemy);
+	EnemyCells.Add(Cell);
+	AgroRadii.Add(Enemy->AgroSphere->GetScaledSphereRadius());
+	CombatRadii.Add(Enemy->CombatSphere->GetScaledSphereRadius());
+
+	Cells.FindOrAdd(Cell).Add(Enemies.Num() - 1);
+
+	MaxRadius = FMath::Max3(MaxRadius, AgroRadii.Last(), CombatRadii.Last());
+}
+
+void ACombatRangeManager::UnregisterEnemy(AEnemy* Enemy)
+{
+	int32 Index = Enemies.Find(Enemy);
+	if (Index != INDEX_NONE)
+	{
+		RemoveEnemyAt(Index);
+	}
+}
+
+void ACombatRangeManager::RemoveEnemyAt(int32 EnemyIndex)
+{
+	AEnemy* Enemy = Enemies[EnemyIndex];
+	RemoveFromCell(EnemyIndex);
+
+	// The last enemy is swapped into the freed slot, so its cell has to point at the new index
+	const int32 LastIndex = Enemies.Num() - 1;
+	if (EnemyIndex != LastIndex)
+	{
+		TArray<int32>& LastCell = Cells.FindChecked(EnemyCells[LastIndex]);
+		LastCell[LastCell.Find(LastIndex)] = EnemyIndex;
+	}
+
+	Enemies.RemoveAtSwap(EnemyIndex);
+	EnemyCells.RemoveAtSwap(EnemyIndex);
+	AgroRadii.RemoveAtSwap(EnemyIndex);
+	CombatRadii.RemoveAtSwap(EnemyIndex);
+
+	// Forget the pairs without sending events, the enemy is going away
+	for (auto It = CurrentRanges.CreateIterator(); It; ++It)
+	{
+		if (It->Key.Key == Enemy)
+		{
+			if (IsValid(It->Key.Value))
+			{
+				It->Key.Value->RemoveTargetCandidate(Enemy);
+			}
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void ACombatRangeManager::RegisterPlayer(AMainCharacter* Player)
+{
+	if (Player)
+	{
+		Players.AddUnique(Player);
+	}
+}
+
+void ACombatRangeManager::UnregisterPlayer(AMainCharacter* Player)
+{
+	Players.RemoveSwap(Player);
+
+	for (auto It = CurrentRanges.CreateIterator(); It; ++It)
+	{
+		if (It->Key.Value == Player)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void ACombatRangeManager::GetEnemiesInAgroRange(const AMainCharacter* Player, TArray<AEnemy*>& OutEnemies) const
+{
+	for (const auto& Pair : CurrentRanges)
+	{
+		if (Pair.Key.Value == Player && (Pair.Value & AgroRangeFlag))
+		{
+			OutEnemies.Add(Pair.Key.Key);
+		}
+	}
+}
+
+void ACombatRangeManager::GetEnemiesInCombatRange(const AMainCharacter* Player, TArray<AEnemy*>& OutEnemies) const
+{
+	for (const auto& Pair : CurrentRanges)
+	{
+		if (Pair.Key.Value == Player && (Pair.Value & CombatRangeFlag))
+		{
+			OutEnemies.Add(Pair.Key.Key);
+		}
+	}
+}
+
+bool ACombatRangeManager::IsInCombatRange(const AEnemy* Enemy, const AMainCharacter* Player) const
+{
+	const uint8* Flags = CurrentRanges.Find(FRangePair(const_cast<AEnemy*>(Enemy), const_cast<AMainCharacter*>(Player)));
+	return Flags && (*Flags & CombatRangeFlag);
+}
+
+FIntPoint ACombatRangeManager::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void ACombatRangeManager::MoveToCell(int32 EnemyIndex, const FIntPoint& NewCell)
+{
+	RemoveFromCell(EnemyIndex);
+
+	Cells.FindOrAdd(NewCell).Add(EnemyIndex);
+	EnemyCells[EnemyIndex] = NewCell;
+}
+
+void ACombatRangeManager::RemoveFromCell(int32 EnemyIndex)
+{
+	TArray<int32>* CellEnemies = Cells.Find(EnemyCells[EnemyIndex]);
+	if (CellEnemies)
+	{
+		CellEnemies->RemoveSwap(EnemyIndex);
+		if (CellEnemies->Num() == 0)
+		{
+			Cells.Remove(EnemyCells[EnemyIndex]);
+		}
+	}
+}
+
+uint8 ACombatRangeManager::ComputeRangeFlags(int32 EnemyIndex, const FVector& PlayerLocation, float PlayerRadius, float PlayerHalfHeight) const
+{
+	AEnemy* Enemy = Enemies[EnemyIndex];
+	if (!Enemy->Alive()) { return 0; }
+
+	// Distance from the sphere centre to the player's capsule segment
+	FVector Delta = Enemy->GetActorLocation() - PlayerLocation;
+	const float SegmentHalfLength = FMath::Max(PlayerHalfHeight - PlayerRadius, 0.f);
+	Delta.Z = FMath::Sign(Delta.Z) * FMath::Max(FMath::Abs(Delta.Z) - SegmentHalfLength, 0.f);
+	const float DistanceSquared = Delta.SizeSquared();
+
+	uint8 Flags = 0;
+	if (DistanceSquared <= FMath::Square(AgroRadii[EnemyIndex] + PlayerRadius))
+	{
+		Flags |= AgroRangeFlag;
+	}
+	if (DistanceSquared <= FMath::Square(CombatRadii[EnemyIndex] + PlayerRadius))
+	{
+		Flags |= CombatRangeFlag;
+	}
+	return Flags;
+}
+
+void ACombatRangeManager::DispatchEvents(const TMap<FRangePair, uint8>& PreviousRanges)
+{
+	TArray<FRangePair> CombatExits;
+	TArray<FRangePair> AgroExits;
+	TArray<FRangePair> AgroEnters;
+	TArray<FRangePair> CombatEnters;
+
+	for (const auto& Pair : PreviousRanges)
+	{
+		const uint8* NewFlags = CurrentRanges.Find(Pair.Key);
+		const uint8 Lost = Pair.Value & ~(NewFlags ? *NewFlags : 0);
+		if (Lost & CombatRangeFlag) { CombatExits.Add(Pair.Key); }
+		if (Lost & AgroRangeFlag) { AgroExits.Add(Pair.Key); }
+	}
+
+	for (const auto& Pair : CurrentRanges)
+	{
+		const uint8* OldFlags = PreviousRanges.Find(Pair.Key);
+		const uint8 Gained = Pair.Value & ~(OldFlags ? *OldFlags : 0);
+		if (Gained & AgroRangeFlag) { AgroEnters.Add(Pair.Key); }
+		if (Gained & CombatRangeFlag) { CombatEnters.Add(Pair.Key); }
+	}
+
+	NumEventsLastFrame = CombatExits.Num() + AgroExits.Num() + AgroEnters.Num() + CombatEnters.Num();
+
+	// Leaving combat range always comes before leaving agro range, and the reverse for entering
+	for (const FRangePair& Pair : CombatExits)
+	{
+		if (IsValid(Pair.Key)) { Pair.Key->CombatRangeEnd(Pair.Value); }
+	}
+	for (const FRangePair& Pair : AgroExits)
+	{
+		if (IsValid(Pair.Key)) { Pair.Key->AgroRangeEnd(Pair.Value); }
+	}
+	for (const FRangePair& Pair : AgroEnters)
+	{
+		if (IsValid(Pair.Key)) { Pair.Key->AgroRangeBegin(Pair.Value); }
+	}
+	for (const FRangePair& Pair : CombatEnters)
+	{
+		if (IsValid(Pair.Key)) { Pair.Key->CombatRangeBegin(Pair.Value); }
+	}
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CombatRangeManager.generated.h"
+
+/**
+ * Uniform grid of enemies that replaces per-enemy AgroSphere/CombatSphere overlaps.
+ * Once per frame every player queries its neighbouring cells with squared-distance tests
+ * and enter/leave events are sent to the enemies in one batch.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API ACombatRangeManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ACombatRangeManager();
+
+	static ACombatRangeManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** Size of a grid cell, should be at least the largest agro radius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat Range")
+	float CellSize;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Range | Stats")
+	int32 NumOccupiedCells;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Range | Stats")
+	int32 NumPairsInRange;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Range | Stats")
+	int32 NumEventsLastFrame;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	void RegisterEnemy(class AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	void RegisterPlayer(class AMainCharacter* Player);
+	void UnregisterPlayer(AMainCharacter* Player);
+
+	/** Living enemies whose agro range currently contains Player */
+	void GetEnemiesInAgroRange(const AMainCharacter* Player, TArray<AEnemy*>& OutEnemies) const;
+
+	/** Living enemies whose combat range currently contains Player */
+	void GetEnemiesInCombatRange(const AMainCharacter* Player, TArray<AEnemy*>& OutEnemies) const;
+
+	bool IsInCombatRange(const AEnemy* Enemy, const AMainCharacter* Player) const;
+
+private:
+	static const uint8 AgroRangeFlag = 1 << 0;
+	static const uint8 CombatRangeFlag = 1 << 1;
+
+	typedef TPair<AEnemy*, AMainCharacter*> FRangePair;
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	void MoveToCell(int32 EnemyIndex, const FIntPoint& NewCell);
+
+	void RemoveFromCell(int32 EnemyIndex);
+
+	void RemoveEnemyAt(int32 EnemyIndex);
+
+	uint8 ComputeRangeFlags(int32 EnemyIndex, const FVector& PlayerLocation, float PlayerRadius, float PlayerHalfHeight) const;
+
+	void DispatchEvents(const TMap<FRangePair, uint8>& PreviousRanges);
+
+	/** Enemies and their cached grid data, kept in matching order */
+	UPROPERTY()
+	TArray<AEnemy*> Enemies;
+	TArray<FIntPoint> EnemyCells;
+	TArray<float> AgroRadii;
+	TArray<float> CombatRadii;
+
+	UPROPERTY()
+	TArray<AMainCharacter*> Players;
+
+	/** Indices into Enemies for each occupied cell */
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	/** Range flags for every enemy/player pair that is in at least agro range */
+	TMap<FRangePair, uint8> CurrentRanges;
+
+	float MaxRadius;
+};
@@ -2,6 +2,7 @@
 
 
 #include "Critter.h"
+#include "BatchTickManager.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/InputComponent.h"
 #include "Camera/CameraComponent.h"
@@ -26,13 +27,32 @@ ACritter::ACritter()
 
 	CurrentVelocity = FVector(0.f);
 	MaxSpeed = 100.f;
+
+	BatchTickId = INDEX_NONE;
 }
 
 // Called when the game starts or when spawned
 void ACritter::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	ABatchTickManager* BatchTickManager = ABatchTickManager::Get(this);
+	if (BatchTickManager && ABatchTickManager::CanBatchTick(this))
+	{
+		BatchTickManager->RegisterCritter(this);
+		SetActorTickEnabled(false);
+	}
+}
+
+void ACritter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ABatchTickManager* BatchTickManager = ABatchTickManager::Get(this, false);
+	if (BatchTickManager)
+	{
+		BatchTickManager->UnregisterCritter(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -56,10 +76,23 @@ void ACritter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 void ACritter::MoveForward(float Value)
 {
 	CurrentVelocity.X = FMath::Clamp(Value, -1.f, 1.f) * MaxSpeed;
+	UpdateBatchedVelocity();
 }
 
 void ACritter::MoveRight(float Value)
 {
 	CurrentVelocity.Y = FMath::Clamp(Value, -1.f, 1.f) * MaxSpeed;
+	UpdateBatchedVelocity();
+}
+
+void ACritter::UpdateBatchedVelocity()
+{
+	if (BatchTickId == INDEX_NONE) { return; }
+
+	ABatchTickManager* BatchTickManager = ABatchTickManager::Get(this, false);
+	if (BatchTickManager)
+	{
+		BatchTickManager->SetCritterVelocity(this, CurrentVelocity);
+	}
 }
 
@@ -19,6 +19,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -35,9 +37,15 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Pawn Movement")
 	float MaxSpeed;
 
+	/** Slot in the batch tick manager, INDEX_NONE while the critter moves itself */
+	int32 BatchTickId;
+
 private:
 	void MoveForward(float Value);
 	void MoveRight(float Value);
 
+	/** Hand CurrentVelocity to the batch tick manager if it moves us */
+	void UpdateBatchedVelocity();
+
 	FVector CurrentVelocity;
 };
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DamageQueue.h"
+#include "WorldManagers.h"
+#include "Enemy.h"
+#include "MainCharacter.h"
+#include "Kismet/GameplayStatics.h"
+
+// Sets default values
+ADamageQueue::ADamageQueue()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	// After physics, animation and melee sweeps have reported their hits for the frame
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	NumQueuedLastFrame = 0;
+	NumDuplicatesLastFrame = 0;
+	NumAppliedLastFrame = 0;
+	ResolveTimeMs = 0.f;
+}
+
+ADamageQueue* ADamageQueue::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<ADamageQueue>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called every frame
+void ADamageQueue::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double StartTime = FPlatformTime::Seconds();
+	Resolve();
+	ResolveTimeMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void ADamageQueue::QueueDamage(AActor* Target, float Amount, AController* EventInstigator, AActor* DamageCauser, TSubclassOf<UDamageType> DamageTypeClass, const FVector& HitLocation)
+{
+	if (Target == nullptr || Amount == 0.f) { return; }
+
+	FQueuedDamage& Damage = Queue.AddDefaulted_GetRef();
+	Damage.Target = Target;
+	Damage.EventInstigator = EventInstigator;
+	Damage.DamageCauser = DamageCauser;
+	Damage.DamageTypeClass = DamageTypeClass;
+	Damage.Amount = Amount;
+	Damage.HitLocation = HitLocation;
+}
+
+void ADamageQueue::Resolve()
+{
+	NumQueuedLastFrame = Queue.Num();
+	NumDuplicatesLastFrame = 0;
+	NumAppliedLastFrame = 0;
+
+	if (Queue.Num() == 0) { return; }
+
+	// Damage applied below can queue more, that waits for the next frame
+	TArray<FQueuedDamage> Pending = MoveTemp(Queue);
+	Queue.Reset();
+
+	// Causers stay in the key after being destroyed, so an explosive that hit and went away is still deduplicated
+	TSet<TPair<TWeakObjectPtr<AActor>, TWeakObjectPtr<AActor>>> Hits;
+	TMap<TPair<TWeakObjectPtr<AActor>, UClass*>, int32> AggregateIndices;
+	TArray<FQueuedDamage> Aggregated;
+	Aggregated.Reserve(Pending.Num());
+
+	for (const FQueuedDamage& Damage : Pending)
+	{
+		bool bAlreadyHit = false;
+		Hits.Add(TPair<TWeakObjectPtr<AActor>, TWeakObjectPtr<AActor>>(Damage.Target, Damage.DamageCauser), &bAlreadyHit);
+		if (bAlreadyHit)
+		{
+			++NumDuplicatesLastFrame;
+			continue;
+		}
+
+		// The first hit on a target keeps its causer and location, later ones of the same type only add to the amount
+		const TPair<TWeakObjectPtr<AActor>, UClass*> Key(Damage.Target, *Damage.DamageTypeClass);
+		const int32* Index = AggregateIndices.Find(Key);
+		if (Index)
+		{
+			Aggregated[*Index].Amount += Damage.Amount;
+		}
+		else
+		{
+			AggregateIndices.Add(Key, Aggregated.Add(Damage));
+		}
+	}
+
+	bool bEnemyDied = false;
+	for (const FQueuedDamage& Damage : Aggregated)
+	{
+		AActor* Target = Damage.Target.Get();
+		if (Target == nullptr) { continue; }
+
+		AEnemy* Enemy = Cast<AEnemy>(Target);
+		if (Enemy && !Enemy->Alive()) { continue; }
+
+		AActor* DamageCauser = Damage.DamageCauser.Get();
+		const FVector HitFromDirection = DamageCauser ? (Damage.HitLocation - DamageCauser->GetActorLocation()).GetSafeNormal() : FVector::ZeroVector;
+		const FHitResult Hit(Target, nullptr, Damage.HitLocation, -HitFromDirection);
+
+		UGameplayStatics::ApplyPointDamage(Target, Damage.Amount, HitFromDirection, Hit, Damage.EventInstigator.Get(), DamageCauser, Damage.DamageTypeClass);
+		++NumAppliedLastFrame;
+
+		if (Enemy && !Enemy->Alive())
+		{
+			bEnemyDied = true;
+		}
+	}
+
+	// Picking a new combat target walks every enemy in range, so it is done once however many died
+	if (bEnemyDied)
+	{
+		AMainCharacter* MainCharacter = Cast<AMainCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+		if (MainCharacter)
+		{
+			MainCharacter->UpdateCombatTarget();
+		}
+	}
+}
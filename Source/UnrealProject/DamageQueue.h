@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/DamageType.h"
+#include "DamageQueue.generated.h"
+
+/**
+ * Collects damage dealt during the frame and applies it in one pass at the end of the frame.
+ * Hits from overlap and sweep callbacks no longer run deaths and collision changes in the middle of physics,
+ * repeated hits of one causer on a target are counted once, and damage of the same type is summed
+ * so each target takes damage, and dies, at most once per frame.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API ADamageQueue : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ADamageQueue();
+
+	static ADamageQueue* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Damage Queue | Stats")
+	int32 NumQueuedLastFrame;
+
+	/** Hits dropped because the same causer already hit the target this frame */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Damage Queue | Stats")
+	int32 NumDuplicatesLastFrame;
+
+	/** TakeDamage calls made after aggregating */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Damage Queue | Stats")
+	int32 NumAppliedLastFrame;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Damage Queue | Stats")
+	float ResolveTimeMs;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	/** Damage Target at the end of the frame */
+	void QueueDamage(AActor* Target, float Amount, class AController* EventInstigator, AActor* DamageCauser, TSubclassOf<UDamageType> DamageTypeClass, const FVector& HitLocation);
+
+private:
+	struct FQueuedDamage
+	{
+		TWeakObjectPtr<AActor> Target;
+		TWeakObjectPtr<AController> EventInstigator;
+		TWeakObjectPtr<AActor> DamageCauser;
+		TSubclassOf<UDamageType> DamageTypeClass;
+		float Amount;
+		FVector HitLocation;
+	};
+
+	void Resolve();
+
+	TArray<FQueuedDamage> Queue;
+};
@@ -4,10 +4,21 @@
 #include "Enemy.h"
 #include "MainCharacter.h"
 #include "MainPlayerController.h"
+#include "EnemySignificanceManager.h"
+#include "CombatRangeManager.h"
+#include "FlowFieldManager.h"
+#include "PathQueryManager.h"
+#include "EnemyPool.h"
+#include "CombatDirector.h"
+#include "FXPool.h"
+#include "DamageQueue.h"
+#include "WorldStateManager.h"
+#include "AssetStreamingSubsystem.h"
 #include "AIController.h"
 #include "TimerManager.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "Components/SphereComponent.h"
 #include "Components/BoxComponent.h"
@@ -15,6 +26,8 @@
 #include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
+#include "Particles/ParticleSystem.h"
 
 // Sets default values
 AEnemy::AEnemy()
@@ -31,10 +44,14 @@ AEnemy::AEnemy()
 	AgroSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AgroSphere"));
 	AgroSphere->SetupAttachment(GetRootComponent());
 	AgroSphere->InitSphereRadius(600.f);
+	AgroSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AgroSphere->SetGenerateOverlapEvents(false);
 
 	CombatSphere = CreateDefaultSubobject<USphereComponent>(TEXT("CombatSphere"));
 	CombatSphere->SetupAttachment(GetRootComponent());
 	CombatSphere->InitSphereRadius(75.f);
+	CombatSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CombatSphere->SetGenerateOverlapEvents(false);
 
 	bOverlappingCombatSphere = false;
 
@@ -55,6 +72,38 @@ AEnemy::AEnemy()
 	DeathDelay = 3.f;
 
 	bHasValidTarget = false;
+
+	ChaseTarget = nullptr;
+	bFollowingFlowField = false;
+
+	// Local avoidance on top of the shared flow field keeps chasing enemies from stacking up
+	GetCharacterMovement()->bUseRVOAvoidance = true;
+
+	Significance = EEnemySignificance::ES_Full;
+
+	CapsuleCollisionBeforeSleep = ECollisionEnabled::QueryAndPhysics;
+
+	bAnimsPausedBeforeSleep = false;
+
+	// Animation updates are skipped and interpolated per significance tier, see ApplyAnimUpdateRate()
+	GetMesh()->bEnableUpdateRateOptimizations = true;
+	GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+
+	FullAnimFrameSkip = 0;
+	ReducedAnimFrameSkip = 1;
+	MinimalAnimFrameSkip = 3;
+	OffscreenAnimUpdateRate = 4;
+	MaxAnimInterpolationRate = 4;
+
+	bPlayingCombatMontage = false;
+
+	HordeMesh = nullptr;
+
+	LeftSwingId = INDEX_NONE;
+	RightSwingId = INDEX_NONE;
+
+	bInPool = false;
+	RegionId = INDEX_NONE;
 }
 
 // Called when the game starts or when spawned
@@ -64,18 +113,7 @@ void AEnemy::BeginPlay()
 
 	AIController = Cast<AAIController>(GetController());
 
-	AgroSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::AgroSphereOnOverlapBegin);
-	AgroSphere->OnComponentEndOverlap.AddDynamic(this, &AEnemy::AgroSphereOnOverlapEnd);
-
-	CombatSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::CombatSphereOnOverlapBegin);
-	CombatSphere->OnComponentEndOverlap.AddDynamic(this, &AEnemy::CombatSphereOnOverlapEnd);
-
-	CombatCollisionLeft->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::CombatLeftOnOverlapBegin);
-	CombatCollisionLeft->OnComponentEndOverlap.AddDynamic(this, &AEnemy::CombatLeftOnOverlapEnd);
-
-	CombatCollisionRight->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::CombatRightOnOverlapBegin);
-	CombatCollisionRight->OnComponentEndOverlap.AddDynamic(this, &AEnemy::CombatRightOnOverlapEnd);
-
+	// The combat boxes only give the melee trace manager their shape, they never collide themselves
 	CombatCollisionLeft->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	CombatCollisionLeft->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
 	CombatCollisionLeft->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
@@ -86,8 +124,54 @@ void AEnemy::BeginPlay()
 	CombatCollisionRight->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	CombatCollisionRight->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
 
+	TipLeftSocket.Init(GetMesh(), FName("TipLeftSocket"));
+	TipRightSocket.Init(GetMesh(), FName("TipRightSocket"));
+
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
 	GetCapsuleComponent()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
+
+	// Ranges are tested by ACombatRangeManager, the spheres only provide their radius
+	AgroSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CombatSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	ApplyAnimUpdateRate();
+
+	if (bInPool) { return; }
+
+	AEnemySignificanceManager* SignificanceManager = AEnemySignificanceManager::Get(this);
+	if (SignificanceManager)
+	{
+		SignificanceManager->RegisterEnemy(this);
+	}
+
+	ACombatRangeManager* CombatRangeManager = ACombatRangeManager::Get(this);
+	if (CombatRangeManager)
+	{
+		CombatRangeManager->RegisterEnemy(this);
+	}
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AEnemySignificanceManager* SignificanceManager = AEnemySignificanceManager::Get(this, false);
+	if (SignificanceManager)
+	{
+		SignificanceManager->UnregisterEnemy(this);
+	}
+
+	ACombatRangeManager* CombatRangeManager = ACombatRangeManager::Get(this, false);
+	if (CombatRangeManager)
+	{
+		CombatRangeManager->UnregisterEnemy(this);
+	}
+
+	ACombatDirector* CombatDirector = ACombatDirector::Get(this, false);
+	if (CombatDirector)
+	{
+		CombatDirector->Disengage(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -95,6 +179,18 @@ void AEnemy::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	if (EnemyMovementStatus == EEnemyMovementStatus::EMS_MoveToTarget && ChaseTarget)
+	{
+		// Inside combat range we spread out to our surround slot instead of walking straight at the player
+		if (!bOverlappingCombatSphere || !SteerToSurroundSlot())
+		{
+			FollowFlowField();
+		}
+	}
+	else if (bFollowingFlowField)
+	{
+		StopFlowField();
+	}
 }
 
 // Called to bind functionality to input
@@ -104,34 +200,49 @@ void AEnemy::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 
 }
 
-void AEnemy::AgroSphereOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::AgroRangeBegin(AMainCharacter* Target)
 {
-	if (OtherActor && Alive())
+	if (Target && Alive())
 	{
-		AMainCharacter* MainCharacter = Cast<AMainCharacter>(OtherActor);
-		if (MainCharacter)
-		{
-			MoveToTarget(MainCharacter);
-		}
+		Target->AddTargetCandidate(this);
+		PreloadCombatAssets(Target);
+		MoveToTarget(Target);
 	}
 }
 
-void AEnemy::AgroSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+void AEnemy::PreloadCombatAssets(AMainCharacter* Target)
 {
-	if (OtherActor)
+	UAssetStreamingSubsystem* AssetStreamingSubsystem = UAssetStreamingSubsystem::Get(this);
+	if (AssetStreamingSubsystem == nullptr) { return; }
+
+	TArray<FSoftObjectPath> Assets;
+	Assets.Add(HitParticles.ToSoftObjectPath());
+	Assets.Add(HitSound.ToSoftObjectPath());
+	Assets.Add(SwingSound.ToSoftObjectPath());
+	Assets.Add(CombatMontage.ToSoftObjectPath());
+	Assets.Add(Target->HitParticles.ToSoftObjectPath());
+	Assets.Add(Target->HitSound.ToSoftObjectPath());
+	AssetStreamingSubsystem->Preload(Assets);
+}
+
+void AEnemy::AgroRangeEnd(AMainCharacter* Target)
+{
+	if (Target)
 	{
-		AMainCharacter* MainCharacter = Cast<AMainCharacter>(OtherActor);
-		if (MainCharacter)
+		Target->RemoveTargetCandidate(this);
+
+		bHasValidTarget = false;
+		if (Target->CombatTarget == this)
 		{
-			bHasValidTarget = false;
-			if (MainCharacter->CombatTarget == this)
-			{
-				MainCharacter->SetCombatTarget(nullptr);
-				MainCharacter->SetHasCombatTarget(false);
+			Target->SetCombatTarget(nullptr);
+			Target->SetHasCombatTarget(false);
 
-				MainCharacter->UpdateCombatTarget();
-			}
+			Target->UpdateCombatTarget();
+		}
 
+		// Dead enemies also leave range, they must keep their dead status
+		if (Alive())
+		{
 			SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Idle);
 			if (AIController)
 			{
@@ -141,53 +252,58 @@ void AEnemy::AgroSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AA
 	}
 }
 
-void AEnemy::CombatSphereOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::CombatRangeBegin(AMainCharacter* Target)
 {
-	if (OtherActor && Alive())
+	if (Target && Alive())
 	{
-		AMainCharacter* MainCharacter = Cast<AMainCharacter>(OtherActor);
-		if (MainCharacter)
-		{
-			bHasValidTarget = true;
+		bHasValidTarget = true;
+
+		// Picks the best scored candidate, or keeps a target the player cycled to
+		Target->UpdateCombatTarget();
 
-			MainCharacter->SetCombatTarget(this);
-			MainCharacter->SetHasCombatTarget(true);
-			MainCharacter->UpdateCombatTarget();
+		CombatTarget = Target;
+		bOverlappingCombatSphere = true;
 
-			CombatTarget = MainCharacter;
-			bOverlappingCombatSphere = true;
+		ACombatDirector* CombatDirector = ACombatDirector::Get(this);
+		if (CombatDirector)
+		{
+			CombatDirector->Engage(this, Target);
+		}
 
-			float AttackTime = FMath::RandRange(AttackMinTime, AttackMaxTime);
-			GetWorldTimerManager().SetTimer(AttackTimer, this, &AEnemy::Attack, AttackTime);
+		if (AIController)
+		{
+			AIController->StopMovement();
 		}
 	}
 }
 
-void AEnemy::CombatSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+void AEnemy::CombatRangeEnd(AMainCharacter* Target)
 {
-	if (OtherActor && OtherComp)
+	if (Target)
 	{
-		AMainCharacter* MainCharacter = Cast<AMainCharacter>(OtherActor);
-		if (MainCharacter)
+		bOverlappingCombatSphere = false;
+		if (Alive())
 		{
-			bOverlappingCombatSphere = false;
-			MoveToTarget(MainCharacter);
-			CombatTarget = nullptr;
+			MoveToTarget(Target);
+		}
+		CombatTarget = nullptr;
 
-			if (MainCharacter->CombatTarget == this)
-			{
-				MainCharacter->SetCombatTarget(nullptr);
-				MainCharacter->bHasCombatTarget = false;
-				MainCharacter->UpdateCombatTarget();
-			}
+		if (Target->CombatTarget == this)
+		{
+			Target->SetCombatTarget(nullptr);
+			Target->bHasCombatTarget = false;
+			Target->UpdateCombatTarget();
+		}
 
-			if (MainCharacter->MainPlayerController)
-			{
-				USkeletalMeshComponent* MainCharacterMesh = Cast<USkeletalMeshComponent>(OtherComp);
-				if (MainCharacterMesh) { MainCharacter->MainPlayerController->RemoveEnemyHealthBar(); }
-			}
-			 
-			GetWorldTimerManager().ClearTimer(AttackTimer);
+		if (Target->MainPlayerController && !Target->bHasCombatTarget)
+		{
+			Target->MainPlayerController->RemoveEnemyHealthBar();
+		}
+
+		ACombatDirector* CombatDirector = ACombatDirector::Get(this, false);
+		if (CombatDirector)
+		{
+			CombatDirector->Disengage(this);
 		}
 	}
 }
@@ -195,23 +311,79 @@ void AEnemy::CombatSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent,
 void AEnemy::MoveToTarget(AMainCharacter* Target)
 {
 	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_MoveToTarget);
+	ChaseTarget = Target;
+
+	if (!FollowFlowField())
+	{
+		RequestPathToTarget();
+	}
+}
+
+bool AEnemy::FollowFlowField()
+{
+	FVector Direction;
+	AFlowFieldManager* FlowFieldManager = AFlowFieldManager::Get(this);
+	if (FlowFieldManager == nullptr || !FlowFieldManager->GetFlowDirection(ChaseTarget, GetActorLocation(), Direction))
+	{
+		// Walked off the field (or it is being rebuilt), hand back to regular pathfinding
+		if (bFollowingFlowField)
+		{
+			StopFlowField();
+			RequestPathToTarget();
+		}
+		return false;
+	}
+
+	if (!bFollowingFlowField)
+	{
+		bFollowingFlowField = true;
+		if (AIController)
+		{
+			AIController->StopMovement();
+		}
+	}
 
+	AddMovementInput(Direction);
 	if (AIController)
 	{
-		FAIMoveRequest MoveRequest;
-		MoveRequest.SetGoalActor(Target);
-		MoveRequest.SetAcceptanceRadius(10.f);
+		AIController->SetFocalPoint(GetActorLocation() + Direction * 100.f, EAIFocusPriority::Move);
+	}
+	return true;
+}
 
-		FNavPathSharedPtr NavPath;
+void AEnemy::StopFlowField()
+{
+	bFollowingFlowField = false;
+	if (AIController)
+	{
+		AIController->ClearFocus(EAIFocusPriority::Move);
+	}
+}
 
-		AIController->MoveTo(MoveRequest, &NavPath);
+bool AEnemy::SteerToSurroundSlot()
+{
+	ACombatDirector* CombatDirector = ACombatDirector::Get(this, false);
+	FVector SlotLocation;
+	if (CombatDirector == nullptr || !CombatDirector->GetSlotLocation(this, SlotLocation)) { return false; }
 
-		/*TArray<FNavPathPoint> PathPoints = NavPath->GetPathPoints();
-		for (FNavPathPoint Point : PathPoints)
-		{
-			FVector Location = Point.Location;
-			UKismetSystemLibrary::DrawDebugSphere(this, Location, 25.f, 8, FLinearColor::Red, 10.f, 1.5f);
-		}*/
+	if (FVector::DistSquared2D(SlotLocation, GetActorLocation()) > FMath::Square(CombatDirector->SlotAcceptanceRadius))
+	{
+		AddMovementInput((SlotLocation - GetActorLocation()).GetSafeNormal2D());
+	}
+
+	if (AIController)
+	{
+		AIController->SetFocalPoint(ChaseTarget->GetActorLocation(), EAIFocusPriority::Move);
+	}
+	return true;
+}
+
+void AEnemy::RequestPathToTarget()
+{
+	APathQueryManager* PathQueryManager = APathQueryManager::Get(this);
+	if (PathQueryManager && ChaseTarget)
+	{
+		PathQueryManager->RequestPath(this, ChaseTarget, 10.f);
 	}
 }
 
@@ -222,22 +394,25 @@ void AEnemy::CombatLeftOnOverlapBegin(UPrimitiveComponent* OverlappedComponent,
 		AMainCharacter* MainCharacter = Cast<AMainCharacter>(OtherActor);
 		if (MainCharacter)
 		{
-			if (MainCharacter->HitParticles)
+			UParticleSystem* Particles = UAssetStreamingSubsystem::Resolve(this, MainCharacter->HitParticles);
+			if (Particles && TipLeftSocket.IsValid())
 			{
-				const USkeletalMeshSocket* TipSocket = GetMesh()->GetSocketByName("TipLeftSocket");
-				if (TipSocket)
+				FVector SocketLocation = TipLeftSocket.GetLocation(GetMesh());
+				AFXPool* FXPool = AFXPool::Get(this);
+				if (FXPool)
 				{
-					FVector SocketLocation = TipSocket->GetSocketLocation(GetMesh());
-					UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), MainCharacter->HitParticles, SocketLocation, FRotator(0.f), false);
+					FXPool->SpawnEffect(Particles, SocketLocation, FRotator(0.f));
 				}
 			}
-			if (MainCharacter->HitSound)
+			USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, MainCharacter->HitSound);
+			if (Sound)
 			{
-				UGameplayStatics::PlaySound2D(this, MainCharacter->HitSound);
+				UGameplayStatics::PlaySound2D(this, Sound);
 			}
-			if (DamageTypeClass)
+			ADamageQueue* DamageQueue = ADamageQueue::Get(this);
+			if (DamageQueue && DamageTypeClass)
 			{
-				UGameplayStatics::ApplyDamage(MainCharacter, Damage, AIController, this, DamageTypeClass);
+				DamageQueue->QueueDamage(MainCharacter, Damage, AIController, this, DamageTypeClass, SweepResult.ImpactPoint);
 			}
 		}
 	}
@@ -254,22 +429,25 @@ void AEnemy::CombatRightOnOverlapBegin(UPrimitiveComponent* OverlappedComponent,
 		AMainCharacter* MainCharacter = Cast<AMainCharacter>(OtherActor);
 		if (MainCharacter)
 		{
-			if (MainCharacter->HitParticles)
+			UParticleSystem* Particles = UAssetStreamingSubsystem::Resolve(this, MainCharacter->HitParticles);
+			if (Particles && TipRightSocket.IsValid())
 			{
-				const USkeletalMeshSocket* TipSocket = GetMesh()->GetSocketByName("TipRightSocket");
-				if (TipSocket)
+				FVector SocketLocation = TipRightSocket.GetLocation(GetMesh());
+				AFXPool* FXPool = AFXPool::Get(this);
+				if (FXPool)
 				{
-					FVector SocketLocation = TipSocket->GetSocketLocation(GetMesh());
-					UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), MainCharacter->HitParticles, SocketLocation, FRotator(0.f), false);
+					FXPool->SpawnEffect(Particles, SocketLocation, FRotator(0.f));
 				}
 			}
-			if (MainCharacter->HitSound)
+			USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, MainCharacter->HitSound);
+			if (Sound)
 			{
-				UGameplayStatics::PlaySound2D(this, MainCharacter->HitSound);
+				UGameplayStatics::PlaySound2D(this, Sound);
 			}
-			if (DamageTypeClass)
+			ADamageQueue* DamageQueue = ADamageQueue::Get(this);
+			if (DamageQueue && DamageTypeClass)
 			{
-				UGameplayStatics::ApplyDamage(MainCharacter, Damage, AIController, this, DamageTypeClass);
+				DamageQueue->QueueDamage(MainCharacter, Damage, AIController, this, DamageTypeClass, SweepResult.ImpactPoint);
 			}
 		}
 	}
@@ -279,32 +457,70 @@ void AEnemy::CombatRightOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, A
 {
 }
 
+void AEnemy::OnLeftMeleeHit(const FHitResult& Hit)
+{
+	CombatLeftOnOverlapBegin(CombatCollisionLeft, Hit.GetActor(), Hit.GetComponent(), Hit.Item, true, Hit);
+}
+
 void AEnemy::ActivateLeftCollision()
 {
-	CombatCollisionLeft->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	if (SwingSound)
+	AMeleeTraceManager* MeleeTraceManager = AMeleeTraceManager::Get(this);
+	if (MeleeTraceManager)
 	{
-		UGameplayStatics::PlaySound2D(this, SwingSound);
+		DeactivateLeftCollision();
+
+		TArray<AActor*> IgnoredActors;
+		IgnoredActors.Add(this);
+		LeftSwingId = MeleeTraceManager->BeginSwing(CombatCollisionLeft, IgnoredActors, FOnMeleeHit::CreateUObject(this, &AEnemy::OnLeftMeleeHit));
+	}
+	USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, SwingSound);
+	if (Sound)
+	{
+		UGameplayStatics::PlaySound2D(this, Sound);
 	}
 }
 
 void AEnemy::DeactivateLeftCollision()
 {
-	CombatCollisionLeft->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AMeleeTraceManager* MeleeTraceManager = AMeleeTraceManager::Get(this, false);
+	if (MeleeTraceManager && LeftSwingId != INDEX_NONE)
+	{
+		MeleeTraceManager->EndSwing(LeftSwingId);
+	}
+	LeftSwingId = INDEX_NONE;
+}
+
+void AEnemy::OnRightMeleeHit(const FHitResult& Hit)
+{
+	CombatRightOnOverlapBegin(CombatCollisionRight, Hit.GetActor(), Hit.GetComponent(), Hit.Item, true, Hit);
 }
 
 void AEnemy::ActivateRightCollision()
 {
-	CombatCollisionRight->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-	if (SwingSound)
+	AMeleeTraceManager* MeleeTraceManager = AMeleeTraceManager::Get(this);
+	if (MeleeTraceManager)
 	{
-		UGameplayStatics::PlaySound2D(this, SwingSound);
+		DeactivateRightCollision();
+
+		TArray<AActor*> IgnoredActors;
+		IgnoredActors.Add(this);
+		RightSwingId = MeleeTraceManager->BeginSwing(CombatCollisionRight, IgnoredActors, FOnMeleeHit::CreateUObject(this, &AEnemy::OnRightMeleeHit));
+	}
+	USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, SwingSound);
+	if (Sound)
+	{
+		UGameplayStatics::PlaySound2D(this, Sound);
 	}
 }
 
 void AEnemy::DeactivateRightCollision()
 {
-	CombatCollisionRight->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AMeleeTraceManager* MeleeTraceManager = AMeleeTraceManager::Get(this, false);
+	if (MeleeTraceManager && RightSwingId != INDEX_NONE)
+	{
+		MeleeTraceManager->EndSwing(RightSwingId);
+	}
+	RightSwingId = INDEX_NONE;
 }
 
 void AEnemy::Attack()
@@ -318,14 +534,18 @@ void AEnemy::Attack()
 		}
 		if (!bAttacking)
 		{
-			bAttacking = true;
+			// Only an attack whose montage plays ever reaches AttackEnd, so bAttacking waits for it
 			UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-			if (AnimInstance && CombatMontage)
+			UAnimMontage* Montage = UAssetStreamingSubsystem::Resolve(this, CombatMontage);
+			if (AnimInstance && Montage && AnimInstance->Montage_Play(Montage, AnimSpeed) > 0.f)
 			{
 				int32 CurrentSection = (Section % NumOfSections) + 1;
 				FString SectionName(FString::Printf(TEXT("Attack_%d"), CurrentSection));
-				AnimInstance->Montage_Play(CombatMontage, AnimSpeed);
-				AnimInstance->Montage_JumpToSection(FName(*SectionName), CombatMontage);
+				bAttacking = true;
+				bPlayingCombatMontage = true;
+				ApplyAnimUpdateRate();
+
+				AnimInstance->Montage_JumpToSection(FName(*SectionName), Montage);
 				++Section;
 			}
 		}
@@ -335,16 +555,33 @@ void AEnemy::Attack()
 void AEnemy::AttackEnd()
 {
 	bAttacking = false;
+	bPlayingCombatMontage = false;
+	ApplyAnimUpdateRate();
+
 	if (bOverlappingCombatSphere)
 	{
+		// The attack token is kept through a combo and only handed back once it is over
 		if (Section == 0)
 		{
-			float AttackTime = FMath::RandRange(AttackMinTime, AttackMaxTime);
-			GetWorldTimerManager().SetTimer(AttackTimer, this, &AEnemy::Attack, AttackTime);
-		}		
+			ACombatDirector* CombatDirector = ACombatDirector::Get(this);
+			if (CombatDirector)
+			{
+				CombatDirector->AttackFinished(this);
+			}
+		}
 		else
 		{
 			Attack();
+
+			// The next hit of the combo couldn't start, the token goes back like at the end of a combo
+			if (!bAttacking)
+			{
+				ACombatDirector* CombatDirector = ACombatDirector::Get(this);
+				if (CombatDirector)
+				{
+					CombatDirector->AttackFinished(this);
+				}
+			}
 		}
 	}
 	
@@ -355,31 +592,39 @@ float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AC
 	Health -= DamageAmount;
 	if (Health <= 0.f)
 	{
-		Die(DamageCauser);
+		Die();
 	}
 	return DamageAmount;
 }
 
-void AEnemy::Die(AActor* Causer)
+void AEnemy::Die()
 {
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if (AnimInstance && CombatMontage)
+	UAnimMontage* Montage = UAssetStreamingSubsystem::Resolve(this, CombatMontage);
+	if (AnimInstance && Montage)
 	{
-		AnimInstance->Montage_Play(CombatMontage, 1.f);
-		AnimInstance->Montage_JumpToSection(FName("Death"), CombatMontage);
+		bPlayingCombatMontage = true;
+		ApplyAnimUpdateRate();
+
+		AnimInstance->Montage_Play(Montage, 1.f);
+		AnimInstance->Montage_JumpToSection(FName("Death"), Montage);
 	}
 	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Dead);
 
-	CombatCollisionLeft->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	CombatCollisionRight->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	AgroSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	CombatSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	ACombatDirector* CombatDirector = ACombatDirector::Get(this, false);
+	if (CombatDirector)
+	{
+		CombatDirector->Disengage(this);
+	}
+
+	DeactivateLeftCollision();
+	DeactivateRightCollision();
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
-	AMainCharacter* MainCharacter = Cast<AMainCharacter>(Causer);
-	if (MainCharacter)
+	AWorldStateManager* WorldStateManager = AWorldStateManager::Get(this, false);
+	if (WorldStateManager)
 	{
-		MainCharacter->UpdateCombatTarget();
+		WorldStateManager->MarkChanged(this);
 	}
 }
 
@@ -388,6 +633,9 @@ void AEnemy::DeathEnd()
 	GetMesh()->bPauseAnims = true;
 	GetMesh()->bNoSkeletonUpdate = true;
 
+	bPlayingCombatMontage = false;
+	ApplyAnimUpdateRate();
+
 	GetWorldTimerManager().SetTimer(DeathTimer, this, &AEnemy::Disappear, DeathDelay);
 }
 
@@ -398,5 +646,193 @@ bool AEnemy::Alive()
 
 void AEnemy::Disappear()
 {
+	AEnemyPool* EnemyPool = AEnemyPool::Get(this);
+	if (EnemyPool && EnemyPool->Release(this)) { return; }
+
 	Destroy();
 }
+
+
+void AEnemy::SetSignificance(EEnemySignificance NewSignificance, float TickInterval)
+{
+	if (Significance == NewSignificance) { return; }
+
+	if (NewSignificance == EEnemySignificance::ES_Dormant)
+	{
+		Sleep();
+	}
+	else
+	{
+		if (IsDormant())
+		{
+			WakeUp();
+		}
+		SetActorTickInterval(TickInterval);
+		GetCharacterMovement()->SetComponentTickInterval(TickInterval);
+	}
+
+	Significance = NewSignificance;
+	ApplyAnimUpdateRate();
+}
+
+void AEnemy::Sleep()
+{
+	if (IsDormant()) { return; }
+
+	SetActorTickEnabled(false);
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+
+	bAnimsPausedBeforeSleep = GetMesh()->bPauseAnims;
+	GetMesh()->bPauseAnims = true;
+	GetMesh()->SetComponentTickEnabled(false);
+
+	if (AIController)
+	{
+		AIController->StopMovement();
+	}
+
+	CapsuleCollisionBeforeSleep = GetCapsuleComponent()->GetCollisionEnabled();
+
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	DeactivateLeftCollision();
+	DeactivateRightCollision();
+
+	Significance = EEnemySignificance::ES_Dormant;
+}
+
+void AEnemy::WakeUp()
+{
+	if (!IsDormant()) { return; }
+
+	SetActorTickEnabled(true);
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+
+	GetMesh()->bPauseAnims = bAnimsPausedBeforeSleep;
+	GetMesh()->SetComponentTickEnabled(true);
+
+	// Dead enemies keep their collision off, Die() already disabled it
+	if (Alive())
+	{
+		GetCapsuleComponent()->SetCollisionEnabled(CapsuleCollisionBeforeSleep);
+	}
+
+	Significance = EEnemySignificance::ES_Full;
+}
+
+void AEnemy::ApplyAnimUpdateRate()
+{
+	FAnimUpdateRateParameters* UpdateRateParams = GetMesh()->AnimUpdateRateParams;
+	if (UpdateRateParams == nullptr) { return; }
+
+	int32 FrameSkip = FullAnimFrameSkip;
+	if (Significance == EEnemySignificance::ES_Reduced)
+	{
+		FrameSkip = ReducedAnimFrameSkip;
+	}
+	else if (Significance == EEnemySignificance::ES_Minimal || Significance == EEnemySignificance::ES_Dormant)
+	{
+		FrameSkip = MinimalAnimFrameSkip;
+	}
+
+	// Skipped frames would bunch up Activate/DeactivateCollision notifies and could drop a whole hit window
+	if (bPlayingCombatMontage)
+	{
+		FrameSkip = 0;
+	}
+
+	// Same skip for every LOD, the tier already accounts for distance and visibility
+	UpdateRateParams->bShouldUseLodMap = true;
+	UpdateRateParams->LODToFrameSkipMap.Reset();
+	for (int32 LOD = 0; LOD < FMath::Max(GetMesh()->GetNumLODs(), 1); LOD++)
+	{
+		UpdateRateParams->LODToFrameSkipMap.Add(LOD, FrameSkip);
+	}
+
+	UpdateRateParams->BaseNonRenderedUpdateRate = bPlayingCombatMontage ? 1 : OffscreenAnimUpdateRate;
+	UpdateRateParams->MaxEvalRateForInterpolation = MaxAnimInterpolationRate;
+}
+
+void AEnemy::ReturnToPool()
+{
+	if (bInPool) { return; }
+
+	GetWorldTimerManager().ClearTimer(DeathTimer);
+
+	ACombatDirector* CombatDirector = ACombatDirector::Get(this, false);
+	if (CombatDirector)
+	{
+		CombatDirector->Disengage(this);
+	}
+
+	// Out of the managers so a parked enemy gets no range events and isn't woken up
+	AEnemySignificanceManager* SignificanceManager = AEnemySignificanceManager::Get(this, false);
+	if (SignificanceManager)
+	{
+		SignificanceManager->UnregisterEnemy(this);
+	}
+
+	ACombatRangeManager* CombatRangeManager = ACombatRangeManager::Get(this, false);
+	if (CombatRangeManager)
+	{
+		CombatRangeManager->UnregisterEnemy(this);
+	}
+
+	Sleep();
+	SetActorHiddenInGame(true);
+
+	bInPool = true;
+	RegionId = INDEX_NONE;
+}
+
+void AEnemy::ResetFromPool(const FVector& Location, const FRotator& Rotation)
+{
+	if (!bInPool) { return; }
+
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+
+	const AEnemy* Defaults = GetClass()->GetDefaultObject<AEnemy>();
+	Health = Defaults->Health;
+	Section = 0;
+	bAttacking = false;
+	bHasValidTarget = false;
+	bOverlappingCombatSphere = false;
+	CombatTarget = nullptr;
+	ChaseTarget = nullptr;
+	bFollowingFlowField = false;
+	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Idle);
+
+	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+	if (AnimInstance)
+	{
+		AnimInstance->StopAllMontages(0.f);
+	}
+	GetMesh()->bNoSkeletonUpdate = false;
+
+	// Die() switched the capsule off before Sleep() saved it, WakeUp() restores these instead
+	bAnimsPausedBeforeSleep = false;
+	CapsuleCollisionBeforeSleep = Defaults->GetCapsuleComponent()->GetCollisionEnabled();
+	WakeUp();
+
+	SetActorTickInterval(0.f);
+	GetCharacterMovement()->SetComponentTickInterval(0.f);
+
+	bPlayingCombatMontage = false;
+	ApplyAnimUpdateRate();
+
+	SetActorHiddenInGame(false);
+	bInPool = false;
+
+	AEnemySignificanceManager* SignificanceManager = AEnemySignificanceManager::Get(this);
+	if (SignificanceManager)
+	{
+		SignificanceManager->RegisterEnemy(this);
+	}
+
+	ACombatRangeManager* CombatRangeManager = ACombatRangeManager::Get(this);
+	if (CombatRangeManager)
+	{
+		CombatRangeManager->RegisterEnemy(this);
+	}
+}
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "MeleeTraceManager.h"
 #include "Enemy.generated.h"
 
 UENUM(BlueprintType)
@@ -17,6 +18,17 @@ enum class EEnemyMovementStatus : uint8
 	EMS_MAX				UMETA(DisplayName = "DefaultMAX")
 };
 
+UENUM(BlueprintType)
+enum class EEnemySignificance : uint8
+{
+	ES_Full			UMETA(DisplayName = "Full"),
+	ES_Reduced		UMETA(DisplayName = "Reduced"),
+	ES_Minimal		UMETA(DisplayName = "Minimal"),
+	ES_Dormant		UMETA(DisplayName = "Dormant"),
+
+	ES_MAX			UMETA(DisplayName = "DefaultMAX")
+};
+
 UCLASS()
 class UNREALPROJECT_API AEnemy : public ACharacter
 {
@@ -29,11 +41,11 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement")
 	EEnemyMovementStatus EnemyMovementStatus;
 
-	/** When player overlaps the enemy chases */
+	/** Player within this radius is chased, only the radius is used (see ACombatRangeManager) */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI")
 	class USphereComponent* AgroSphere;
 
-	/** When player overlaps the enemy attacks */
+	/** Player within this radius is attacked, only the radius is used (see ACombatRangeManager) */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI")
 	USphereComponent* CombatSphere;
 
@@ -57,20 +69,35 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "AI")
 	AMainCharacter* CombatTarget;
 
+	/** Target being chased while in MoveToTarget */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI")
+	AMainCharacter* ChaseTarget;
+
+	/** Steering from the shared flow field rather than following an AIController path */
+	bool bFollowingFlowField;
+
 	/** Particles emitted when hit */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
-	class UParticleSystem* HitParticles;
+	TSoftObjectPtr<class UParticleSystem> HitParticles;
 
 	/** Sound played when hit */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
-	class USoundCue* HitSound;
+	TSoftObjectPtr<class USoundCue> HitSound;
 
 	/** Sound played when attacking */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
-	USoundCue* SwingSound;
+	TSoftObjectPtr<USoundCue> SwingSound;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Combat")
-	class UAnimMontage* CombatMontage;
+	TSoftObjectPtr<class UAnimMontage> CombatMontage;
+
+	/** Swings opened in the melee trace manager by Activate/DeactivateLeftCollision and their right counterparts */
+	int32 LeftSwingId;
+	int32 RightSwingId;
+
+	/** Where hit particles spawn for each fist */
+	FMeleeSocket TipLeftSocket;
+	FMeleeSocket TipRightSocket;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat")
 	bool bAttacking;
@@ -86,8 +113,6 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Combat")
 	int32 Section;
 
-	FTimerHandle AttackTimer;
-
 	FTimerHandle DeathTimer;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
@@ -114,10 +139,50 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI | Enemy Stats")
 	float Damage;
 
+	/** Tick tier assigned by the significance manager */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI | Significance")
+	EEnemySignificance Significance;
+
+	/** Collision state to restore when waking from dormancy */
+	ECollisionEnabled::Type CapsuleCollisionBeforeSleep;
+
+	bool bAnimsPausedBeforeSleep;
+
+	/** Frames skipped between animation updates in each significance tier, skipped frames are interpolated */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Animation")
+	int32 FullAnimFrameSkip;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Animation")
+	int32 ReducedAnimFrameSkip;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Animation")
+	int32 MinimalAnimFrameSkip;
+
+	/** Animation update rate while not rendered, off-screen only montages are ticked */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Animation")
+	int32 OffscreenAnimUpdateRate;
+
+	/** Skipped frames are interpolated up to this update rate, slower updates hold the last pose */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Animation")
+	int32 MaxAnimInterpolationRate;
+
+	/** Stand-in drawn while this enemy is a background agent of the horde manager */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Horde")
+	class UStaticMesh* HordeMesh;
+
+	/** Attack or death montage is playing, animation runs at full rate until it ends */
+	bool bPlayingCombatMontage;
+
+	/** Parked in the enemy pool, waiting to be spawned again */
+	bool bInPool;
+
+	/** Region of the enemy region manager this enemy was spawned for, INDEX_NONE if it wasn't */
+	int32 RegionId;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -128,19 +193,30 @@ public:
 	FORCEINLINE EEnemyMovementStatus GetEnemyMovementStatus() { return EnemyMovementStatus; }
 	FORCEINLINE void SetEnemyMovementStatus(EEnemyMovementStatus Status) { EnemyMovementStatus = Status; }
 
-	UFUNCTION()
-	virtual void AgroSphereOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-	UFUNCTION()
-	virtual void AgroSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+	/** Called by the combat range manager when Target comes within AgroSphere's radius */
+	virtual void AgroRangeBegin(class AMainCharacter* Target);
+	virtual void AgroRangeEnd(AMainCharacter* Target);
 
-	UFUNCTION()
-	virtual void CombatSphereOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-	UFUNCTION()
-	virtual void CombatSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+	/** Start loading the assets a fight with Target uses, ours and Target's hit effects */
+	void PreloadCombatAssets(AMainCharacter* Target);
+
+	/** Called by the combat range manager when Target comes within CombatSphere's radius */
+	virtual void CombatRangeBegin(AMainCharacter* Target);
+	virtual void CombatRangeEnd(AMainCharacter* Target);
 
 	UFUNCTION(BlueprintCallable)
 	void MoveToTarget(class AMainCharacter* Target);
 
+	/** Steer one step along ChaseTarget's flow field, returns false if the field can't be used here */
+	bool FollowFlowField();
+	void StopFlowField();
+
+	/** Walk to the surround slot the combat director gave us, returns false if we have none */
+	bool SteerToSurroundSlot();
+
+	/** Regular navmesh path to ChaseTarget through the batched path queries, used until the flow field is available */
+	void RequestPathToTarget();
+
 	UFUNCTION()
 	void CombatLeftOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 	UFUNCTION()
@@ -151,6 +227,10 @@ public:
 	UFUNCTION()
 	void CombatRightOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
+	/** Hits reported by the melee trace manager, forwarded to the overlap handlers */
+	void OnLeftMeleeHit(const FHitResult& Hit);
+	void OnRightMeleeHit(const FHitResult& Hit);
+
 	UFUNCTION(BlueprintCallable)
 	void ActivateLeftCollision();
 	UFUNCTION(BlueprintCallable)
@@ -168,7 +248,7 @@ public:
 
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
 
-	void Die(AActor* Causer);
+	void Die();
 
 	UFUNCTION(BlueprintCallable)
 	void DeathEnd();
@@ -176,4 +256,24 @@ public:
 	bool Alive();
 
 	void Disappear();
+
+	/** Apply a significance tier, ticking at TickInterval or going dormant */
+	void SetSignificance(EEnemySignificance NewSignificance, float TickInterval);
+
+	/** Stop ticking, collision and animation until woken */
+	void Sleep();
+	void WakeUp();
+
+	FORCEINLINE bool IsDormant() const { return Significance == EEnemySignificance::ES_Dormant; }
+
+	/** Push the frame skip for the current significance tier to the mesh's update rate optimizations */
+	void ApplyAnimUpdateRate();
+
+	/** Hide and switch off everything while parked in the enemy pool */
+	void ReturnToPool();
+
+	/** Bring a pooled enemy back at Location with its default stats */
+	void ResetFromPool(const FVector& Location, const FRotator& Rotation);
+
+	FORCEINLINE bool IsInPool() const { return bInPool; }
 };
\ No newline at end of file
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyPool.h"
+#include "WorldManagers.h"
+#include "Enemy.h"
+#include "AIController.h"
+
+// Sets default values
+AEnemyPool::AEnemyPool()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	MaxPooledPerClass = 32;
+
+	NumPooled = 0;
+	NumSpawned = 0;
+	NumReused = 0;
+}
+
+AEnemyPool* AEnemyPool::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<AEnemyPool>(WorldContextObject, bSpawnIfMissing);
+}
+
+void AEnemyPool::Prewarm(TSubclassOf<AEnemy> Class, int32 Count, const FVector& Location)
+{
+	if (Class == nullptr) { return; }
+
+	FEnemyPoolList& Pool = Pools.FindOrAdd(Class);
+	const int32 Target = FMath::Min(Count, MaxPooledPerClass);
+
+	while (Pool.Enemies.Num() < Target)
+	{
+		AEnemy* Enemy = SpawnEnemy(Class, Location, FRotator(0.f));
+		if (Enemy == nullptr) { break; }
+
+		Enemy->ReturnToPool();
+		Pool.Enemies.Add(Enemy);
+		++NumPooled;
+	}
+}
+
+AEnemy* AEnemyPool::Acquire(TSubclassOf<AEnemy> Class, const FVector& Location, const FRotator& Rotation)
+{
+	if (Class == nullptr) { return nullptr; }
+
+	FEnemyPoolList* Pool = Pools.Find(Class);
+	while (Pool && Pool->Enemies.Num() > 0)
+	{
+		AEnemy* Enemy = Pool->Enemies.Pop(false);
+		--NumPooled;
+
+		// Pooled enemies can still be destroyed by a level unload
+		if (IsValid(Enemy))
+		{
+			Enemy->ResetFromPool(Location, Rotation);
+
+			// Placed like a fresh spawn, moved out of whatever it would overlap if there is room and left there if not
+			FVector AdjustedLocation = Location;
+			if (GetWorld()->FindTeleportSpot(Enemy, AdjustedLocation, Rotation) && !AdjustedLocation.Equals(Location))
+			{
+				Enemy->SetActorLocation(AdjustedLocation, false, nullptr, ETeleportType::ResetPhysics);
+			}
+
+			++NumReused;
+			return Enemy;
+		}
+	}
+
+	return SpawnEnemy(Class, Location, Rotation);
+}
+
+bool AEnemyPool::Release(AEnemy* Enemy)
+{
+	if (!IsValid(Enemy) || Enemy->IsInPool()) { return false; }
+
+	FEnemyPoolList& Pool = Pools.FindOrAdd(Enemy->GetClass());
+	if (Pool.Enemies.Num() >= MaxPooledPerClass) { return false; }
+
+	Enemy->ReturnToPool();
+	Pool.Enemies.Add(Enemy);
+	++NumPooled;
+	return true;
+}
+
+AEnemy* AEnemyPool::SpawnEnemy(UClass* Class, const FVector& Location, const FRotator& Rotation)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) { return nullptr; }
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	AEnemy* Enemy = World->SpawnActor<AEnemy>(Class, Location, Rotation, SpawnParams);
+	if (Enemy)
+	{
+		Enemy->SpawnDefaultController();
+
+		AAIController* AIController = Cast<AAIController>(Enemy->GetController());
+		if (AIController)
+		{
+			Enemy->AIController = AIController;
+		}
+		++NumSpawned;
+	}
+	return Enemy;
+}
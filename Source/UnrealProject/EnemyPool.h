@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "EnemyPool.generated.h"
+
+USTRUCT()
+struct FEnemyPoolList
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<class AEnemy*> Enemies;
+};
+
+/**
+ * Per-class pool of enemies, dead enemies are parked here instead of being destroyed
+ * and handed back out by spawn volumes, so waves don't create new actors, controllers and physics bodies.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API AEnemyPool : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AEnemyPool();
+
+	static AEnemyPool* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** Enemies kept per class, anything returned beyond this is destroyed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pool")
+	int32 MaxPooledPerClass;
+
+	/** Enemies currently parked in the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pool | Stats")
+	int32 NumPooled;
+
+	/** Enemies spawned because the pool had none to give */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pool | Stats")
+	int32 NumSpawned;
+
+	/** Enemies handed out again from the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pool | Stats")
+	int32 NumReused;
+
+	/** Spawn enemies of Class until Count of them are waiting in the pool */
+	void Prewarm(TSubclassOf<AEnemy> Class, int32 Count, const FVector& Location);
+
+	/** Take an enemy of Class from the pool, or spawn one if there are none. Either way it is nudged out of overlaps like AdjustIfPossibleButAlwaysSpawn */
+	AEnemy* Acquire(TSubclassOf<AEnemy> Class, const FVector& Location, const FRotator& Rotation);
+
+	/** Park Enemy in the pool, returns false if its class is full and the caller should destroy it */
+	bool Release(AEnemy* Enemy);
+
+private:
+	AEnemy* SpawnEnemy(UClass* Class, const FVector& Location, const FRotator& Rotation);
+
+	UPROPERTY()
+	TMap<UClass*, FEnemyPoolList> Pools;
+};
@@ -0,0 +1,247 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyRegionManager.h"
+#include "WorldManagers.h"
+#include "EnemyPool.h"
+#include "SpawnVolume.h"
+#include "GameFramework/Character.h"
+#include "Kismet/GameplayStatics.h"
+
+// Sets default values
+AEnemyRegionManager::AEnemyRegionManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	ActivationRadius = 6000.f;
+	DeactivationRadius = 8000.f;
+	UpdateInterval = 0.5f;
+
+	NumActiveRegions = 0;
+	NumLiveEnemies = 0;
+	NumRecordedEnemies = 0;
+
+	TimeSinceUpdate = 0.f;
+}
+
+AEnemyRegionManager* AEnemyRegionManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<AEnemyRegionManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called every frame
+void AEnemyRegionManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < UpdateInterval) { return; }
+	TimeSinceUpdate = 0.f;
+
+	ACharacter* Player = UGameplayStatics::GetPlayerCharacter(this, 0);
+	if (Player == nullptr) { return; }
+
+	const FVector PlayerLocation = Player->GetActorLocation();
+	for (int32 RegionId = 0; RegionId < Regions.Num(); RegionId++)
+	{
+		FEnemyRegion& Region = Regions[RegionId];
+		if (Region.Volume == nullptr)
+		{
+			// Enemies still fighting when the volume's level unloaded are recorded once they let go
+			if (Region.Enemies.Num() > 0)
+			{
+				VirtualizeEnemies(RegionId);
+			}
+			continue;
+		}
+
+		const float DistanceSquared = FVector::DistSquared(PlayerLocation, Region.Location);
+		if (!Region.bActive && DistanceSquared <= ActivationRadius * ActivationRadius)
+		{
+			ActivateRegion(RegionId);
+		}
+		else if (Region.bActive && DistanceSquared > DeactivationRadius * DeactivationRadius)
+		{
+			DeactivateRegion(RegionId);
+		}
+		else if (!Region.bActive && Region.Enemies.Num() > 0)
+		{
+			VirtualizeEnemies(RegionId);
+		}
+	}
+
+	UpdateStats();
+}
+
+void AEnemyRegionManager::RegisterVolume(ASpawnVolume* Volume)
+{
+	if (Volume == nullptr) { return; }
+
+	const FString Key = GetRegionKey(Volume);
+	int32* RegionId = RegionIds.Find(Key);
+	if (RegionId == nullptr)
+	{
+		RegionId = &RegionIds.Add(Key, Regions.AddDefaulted());
+	}
+
+	// Inactive until the next check, anything spawned before then is recorded and appears with the region
+	FEnemyRegion& Region = Regions[*RegionId];
+	Region.Volume = Volume;
+	Region.Location = Volume->GetActorLocation();
+}
+
+void AEnemyRegionManager::UnregisterVolume(ASpawnVolume* Volume, EEndPlayReason::Type EndPlayReason)
+{
+	const int32* RegionId = RegionIds.Find(GetRegionKey(Volume));
+	if (RegionId == nullptr) { return; }
+
+	// Only a level unload brings the volume back later, its enemies wait as records until then
+	if (EndPlayReason == EEndPlayReason::RemovedFromWorld)
+	{
+		DeactivateRegion(*RegionId);
+	}
+	Regions[*RegionId].Volume = nullptr;
+
+	UpdateStats();
+}
+
+bool AEnemyRegionManager::IsRegionActive(const ASpawnVolume* Volume) const
+{
+	const int32* RegionId = RegionIds.Find(GetRegionKey(Volume));
+	return RegionId && Regions[*RegionId].bActive;
+}
+
+AEnemy* AEnemyRegionManager::SpawnEnemy(ASpawnVolume* Volume, TSubclassOf<AEnemy> EnemyClass, const FVector& Location, const FRotator& Rotation)
+{
+	if (Volume == nullptr || EnemyClass == nullptr) { return nullptr; }
+
+	const int32* RegionId = RegionIds.Find(GetRegionKey(Volume));
+	if (RegionId == nullptr)
+	{
+		RegisterVolume(Volume);
+		RegionId = RegionIds.Find(GetRegionKey(Volume));
+	}
+
+	FEnemyRegion& Region = Regions[*RegionId];
+	if (!Region.bActive)
+	{
+		FEnemyRecord& Record = Region.Records.AddDefaulted_GetRef();
+		Record.EnemyClass = EnemyClass;
+		Record.Health = EnemyClass->GetDefaultObject<AEnemy>()->Health;
+		Record.Location = Location;
+		Record.Rotation = Rotation;
+		++NumRecordedEnemies;
+		return nullptr;
+	}
+
+	AEnemyPool* EnemyPool = AEnemyPool::Get(this);
+	if (EnemyPool == nullptr) { return nullptr; }
+
+	AEnemy* Enemy = EnemyPool->Acquire(EnemyClass, Location, Rotation);
+	if (Enemy)
+	{
+		Enemy->RegionId = *RegionId;
+		Region.Enemies.Add(Enemy);
+		++NumLiveEnemies;
+	}
+	return Enemy;
+}
+
+void AEnemyRegionManager::ActivateRegion(int32 RegionId)
+{
+	FEnemyRegion& Region = Regions[RegionId];
+	if (Region.bActive) { return; }
+	Region.bActive = true;
+
+	AEnemyPool* EnemyPool = AEnemyPool::Get(this);
+	if (EnemyPool == nullptr) { return; }
+
+	for (const FEnemyRecord& Record : Region.Records)
+	{
+		AEnemy* Enemy = EnemyPool->Acquire(Record.EnemyClass, Record.Location, Record.Rotation);
+		if (Enemy == nullptr) { continue; }
+
+		// Whoever it was fighting is long gone, so it comes back idle
+		Enemy->Health = Record.Health;
+		Enemy->RegionId = RegionId;
+		Region.Enemies.Add(Enemy);
+	}
+	Region.Records.Reset();
+}
+
+void AEnemyRegionManager::DeactivateRegion(int32 RegionId)
+{
+	FEnemyRegion& Region = Regions[RegionId];
+	if (!Region.bActive) { return; }
+	Region.bActive = false;
+
+	VirtualizeEnemies(RegionId);
+}
+
+void AEnemyRegionManager::VirtualizeEnemies(int32 RegionId)
+{
+	FEnemyRegion& Region = Regions[RegionId];
+
+	AEnemyPool* EnemyPool = AEnemyPool::Get(this);
+	for (int32 i = Region.Enemies.Num() - 1; i >= 0; i--)
+	{
+		// Dead enemies stay dead, and pooled ones may already belong to another region
+		AEnemy* Enemy = Region.Enemies[i].Get();
+		if (!IsValid(Enemy) || Enemy->IsInPool() || Enemy->RegionId != RegionId || !Enemy->Alive())
+		{
+			Region.Enemies.RemoveAtSwap(i);
+			continue;
+		}
+
+		// Checked again every update until it has let go of the player
+		if (IsEnemyEngaged(Enemy)) { continue; }
+
+		FEnemyRecord& Record = Region.Records.AddDefaulted_GetRef();
+		Record.EnemyClass = Enemy->GetClass();
+		Record.Health = Enemy->Health;
+		Record.Location = Enemy->GetActorLocation();
+		Record.Rotation = Enemy->GetActorRotation();
+
+		Region.Enemies.RemoveAtSwap(i);
+		if (EnemyPool == nullptr || !EnemyPool->Release(Enemy))
+		{
+			Enemy->Destroy();
+		}
+	}
+}
+
+bool AEnemyRegionManager::IsEnemyEngaged(const AEnemy* Enemy) const
+{
+	if (Enemy->bHasValidTarget) { return true; }
+
+	const EEnemyMovementStatus Status = Enemy->EnemyMovementStatus;
+	if (Status == EEnemyMovementStatus::EMS_MoveToTarget || Status == EEnemyMovementStatus::EMS_Attacking) { return true; }
+
+	ACharacter* Player = UGameplayStatics::GetPlayerCharacter(this, 0);
+	return Player && FVector::DistSquared(Player->GetActorLocation(), Enemy->GetActorLocation()) <= DeactivationRadius * DeactivationRadius;
+}
+
+void AEnemyRegionManager::UpdateStats()
+{
+	NumActiveRegions = 0;
+	NumLiveEnemies = 0;
+	NumRecordedEnemies = 0;
+	for (int32 RegionId = 0; RegionId < Regions.Num(); RegionId++)
+	{
+		FEnemyRegion& Region = Regions[RegionId];
+		if (Region.bActive)
+		{
+			++NumActiveRegions;
+		}
+
+		Region.Enemies.RemoveAll([RegionId](const TWeakObjectPtr<AEnemy>& Enemy) { return !Enemy.IsValid() || Enemy->IsInPool() || Enemy->RegionId != RegionId; });
+		NumLiveEnemies += Region.Enemies.Num();
+		NumRecordedEnemies += Region.Records.Num();
+	}
+}
+
+FString AEnemyRegionManager::GetRegionKey(const ASpawnVolume* Volume)
+{
+	return UWorld::RemovePIEPrefix(Volume->GetPathName());
+}
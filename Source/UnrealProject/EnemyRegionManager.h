@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Enemy.h"
+#include "EnemyRegionManager.generated.h"
+
+/** What it takes to bring a virtualized enemy back */
+USTRUCT()
+struct FEnemyRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<AEnemy> EnemyClass;
+
+	float Health;
+
+	FVector Location;
+	FRotator Rotation;
+
+	FEnemyRecord()
+	{
+		EnemyClass = nullptr;
+		Health = 0.f;
+		Location = FVector::ZeroVector;
+		Rotation = FRotator::ZeroRotator;
+	}
+};
+
+/** Enemies of one spawn volume, live while the region is active and as records while it isn't */
+USTRUCT()
+struct FEnemyRegion
+{
+	GENERATED_BODY()
+
+	/** Null while the volume's level is unloaded */
+	UPROPERTY()
+	class ASpawnVolume* Volume;
+
+	FVector Location;
+
+	bool bActive;
+
+	UPROPERTY()
+	TArray<TWeakObjectPtr<AEnemy>> Enemies;
+
+	UPROPERTY()
+	TArray<FEnemyRecord> Records;
+
+	FEnemyRegion()
+	{
+		Volume = nullptr;
+		Location = FVector::ZeroVector;
+		bActive = false;
+	}
+};
+
+/**
+ * Virtualizes the enemies spawn volumes create, so only the ones near the player are actors.
+ * A region is a spawn volume, it is active while the player is within ActivationRadius of it and its level is loaded.
+ * Deactivating turns the region's living enemies into records and parks the actors in the enemy pool,
+ * activating spawns them again from the records with the health and place they had.
+ * Enemies fighting the player or still near them stay actors until they are neither, whatever their region does.
+ * Regions are kept by the volume's path, so a volume in a tile that unloads and loads again finds its records.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API AEnemyRegionManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AEnemyRegionManager();
+
+	static AEnemyRegionManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** Regions closer than this to the player are active */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy Regions")
+	float ActivationRadius;
+
+	/** Regions further than this are deactivated, kept above ActivationRadius so a region at the edge doesn't flicker */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy Regions")
+	float DeactivationRadius;
+
+	/** Seconds between activation checks */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Enemy Regions")
+	float UpdateInterval;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Enemy Regions | Stats")
+	int32 NumActiveRegions;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Enemy Regions | Stats")
+	int32 NumLiveEnemies;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Enemy Regions | Stats")
+	int32 NumRecordedEnemies;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	void RegisterVolume(ASpawnVolume* Volume);
+	void UnregisterVolume(ASpawnVolume* Volume, EEndPlayReason::Type EndPlayReason);
+
+	bool IsRegionActive(const ASpawnVolume* Volume) const;
+
+	/** Spawn an enemy for Volume, or only record it if the region is inactive and it would be virtualized straight away */
+	AEnemy* SpawnEnemy(ASpawnVolume* Volume, TSubclassOf<AEnemy> EnemyClass, const FVector& Location, const FRotator& Rotation);
+
+private:
+	void ActivateRegion(int32 RegionId);
+	void DeactivateRegion(int32 RegionId);
+
+	/** Record and release the enemies of an inactive region that are out of the fight and away from the player */
+	void VirtualizeEnemies(int32 RegionId);
+
+	/** Enemies chasing or attacking the player, or close to them, must not vanish in front of them */
+	bool IsEnemyEngaged(const AEnemy* Enemy) const;
+
+	void UpdateStats();
+
+	static FString GetRegionKey(const ASpawnVolume* Volume);
+
+	UPROPERTY()
+	TArray<FEnemyRegion> Regions;
+
+	/** Volume paths to indices into Regions, which are what AEnemy::RegionId holds */
+	TMap<FString, int32> RegionIds;
+
+	float TimeSinceUpdate;
+};
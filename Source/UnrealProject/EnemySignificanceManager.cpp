@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySignificanceManager.h"
+#include "WorldManagers.h"
+#include "MainCharacter.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+
+// Sets default values
+AEnemySignificanceManager::AEnemySignificanceManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	FullDistance = 2000.f;
+	ReducedDistance = 4000.f;
+	MinimalDistance = 8000.f;
+
+	ReducedTickInterval = 0.1f;
+	MinimalTickInterval = 0.25f;
+
+	OffscreenDistanceScale = 1.5f;
+	Hysteresis = 250.f;
+
+	NumFull = 0;
+	NumReduced = 0;
+	NumMinimal = 0;
+	NumDormant = 0;
+}
+
+AEnemySignificanceManager* AEnemySignificanceManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<AEnemySignificanceManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called when the game starts or when spawned
+void AEnemySignificanceManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Keep the tiers ordered even if they were misconfigured in the editor
+	ReducedDistance = FMath::Max(ReducedDistance, FullDistance);
+	MinimalDistance = FMath::Max(MinimalDistance, ReducedDistance);
+}
+
+// Called every frame
+void AEnemySignificanceManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	AMainCharacter* MainCharacter = Cast<AMainCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	if (MainCharacter == nullptr) { return; }
+
+	const FVector PlayerLocation = MainCharacter->GetActorLocation();
+	FVector ViewLocation = PlayerLocation;
+	FVector ViewDirection = MainCharacter->GetActorForwardVector();
+
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0);
+	if (PlayerController && PlayerController->PlayerCameraManager)
+	{
+		ViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		ViewDirection = PlayerController->PlayerCameraManager->GetCameraRotation().Vector();
+	}
+
+	NumFull = 0;
+	NumReduced = 0;
+	NumMinimal = 0;
+	NumDormant = 0;
+
+	for (int32 i = Enemies.Num() - 1; i >= 0; i--)
+	{
+		AEnemy* Enemy = Enemies[i];
+		if (Enemy == nullptr || Enemy->IsPendingKill())
+		{
+			Enemies.RemoveAtSwap(i);
+			continue;
+		}
+
+		EEnemySignificance NewSignificance = ScoreEnemy(Enemy, PlayerLocation, ViewLocation, ViewDirection);
+		Enemy->SetSignificance(NewSignificance, GetTickInterval(NewSignificance));
+
+		switch (NewSignificance)
+		{
+			case EEnemySignificance::ES_Full:
+				++NumFull;
+				break;
+			case EEnemySignificance::ES_Reduced:
+				++NumReduced;
+				break;
+			case EEnemySignificance::ES_Minimal:
+				++NumMinimal;
+				break;
+			default:
+				++NumDormant;
+				break;
+		}
+	}
+}
+
+void AEnemySignificanceManager::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy)
+	{
+		Enemies.AddUnique(Enemy);
+	}
+}
+
+void AEnemySignificanceManager::UnregisterEnemy(AEnemy* Enemy)
+{
+	Enemies.RemoveSwap(Enemy);
+}
+
+float AEnemySignificanceManager::GetTickInterval(EEnemySignificance InSignificance) const
+{
+	switch (InSignificance)
+	{
+		case EEnemySignificance::ES_Reduced:
+			return ReducedTickInterval;
+		case EEnemySignificance::ES_Minimal:
+		case EEnemySignificance::ES_Dormant:
+			return MinimalTickInterval;
+		default:
+			return 0.f;
+	}
+}
+
+EEnemySignificance AEnemySignificanceManager::ScoreEnemy(const AEnemy* Enemy, const FVector& PlayerLocation, const FVector& ViewLocation, const FVector& ViewDirection) const
+{
+	// Anything already chasing or fighting the player stays fully simulated
+	if (Enemy->CombatTarget || Enemy->EnemyMovementStatus == EEnemyMovementStatus::EMS_MoveToTarget || Enemy->EnemyMovementStatus == EEnemyMovementStatus::EMS_Attacking)
+	{
+		return EEnemySignificance::ES_Full;
+	}
+
+	const FVector EnemyLocation = Enemy->GetActorLocation();
+	float DistanceSquared = FVector::DistSquared(EnemyLocation, PlayerLocation);
+
+	const bool bInFront = FVector::DotProduct(EnemyLocation - ViewLocation, ViewDirection) > 0.f;
+	if (!bInFront && !Enemy->WasRecentlyRendered(0.2f))
+	{
+		DistanceSquared *= FMath::Square(OffscreenDistanceScale);
+	}
+
+	EEnemySignificance NewSignificance = TierForDistanceSquared(DistanceSquared);
+	if (NewSignificance > Enemy->Significance)
+	{
+		// Only drop a tier once the enemy is clearly past the threshold
+		const float Distance = FMath::Max(FMath::Sqrt(DistanceSquared) - Hysteresis, 0.f);
+		NewSignificance = FMath::Max(Enemy->Significance, TierForDistanceSquared(FMath::Square(Distance)));
+	}
+	return NewSignificance;
+}
+
+EEnemySignificance AEnemySignificanceManager::TierForDistanceSquared(float DistanceSquared) const
+{
+	if (DistanceSquared <= FMath::Square(FullDistance)) { return EEnemySignificance::ES_Full; }
+	if (DistanceSquared <= FMath::Square(ReducedDistance)) { return EEnemySignificance::ES_Reduced; }
+	if (DistanceSquared <= FMath::Square(MinimalDistance)) { return EEnemySignificance::ES_Minimal; }
+	return EEnemySignificance::ES_Dormant;
+}
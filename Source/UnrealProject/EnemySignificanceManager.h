@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Enemy.h"
+#include "EnemySignificanceManager.generated.h"
+
+/**
+ * Scores every registered enemy by distance and view to the player once per frame
+ * and moves it between tick-interval tiers, putting the least significant to sleep.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API AEnemySignificanceManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AEnemySignificanceManager();
+
+	static AEnemySignificanceManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** Enemies closer than this tick every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float FullDistance;
+
+	/** Enemies closer than this tick at ReducedTickInterval */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float ReducedDistance;
+
+	/** Enemies closer than this tick at MinimalTickInterval, anything further sleeps */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float MinimalDistance;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float ReducedTickInterval;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float MinimalTickInterval;
+
+	/** Distance multiplier for enemies that are behind the camera and were not rendered recently */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float OffscreenDistanceScale;
+
+	/** Extra distance an enemy must move past a threshold before it drops a tier, stops tiers flickering */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float Hysteresis;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Significance | Stats")
+	int32 NumFull;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Significance | Stats")
+	int32 NumReduced;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Significance | Stats")
+	int32 NumMinimal;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Significance | Stats")
+	int32 NumDormant;
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+public:
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	void RegisterEnemy(AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	float GetTickInterval(EEnemySignificance InSignificance) const;
+
+private:
+	EEnemySignificance ScoreEnemy(const AEnemy* Enemy, const FVector& PlayerLocation, const FVector& ViewLocation, const FVector& ViewDirection) const;
+
+	EEnemySignificance TierForDistanceSquared(float DistanceSquared) const;
+
+	UPROPERTY()
+	TArray<AEnemy*> Enemies;
+};
@@ -3,10 +3,14 @@
 
 #include "Explosive.h"
 #include "MainCharacter.h"
+#include "FXPool.h"
+#include "DamageQueue.h"
 #include "Enemy.h"
+#include "AssetStreamingSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "Engine/World.h"
 #include "Sound/SoundCue.h"
+#include "Particles/ParticleSystem.h"
 
 AExplosive::AExplosive()
 {
@@ -23,15 +27,25 @@ void AExplosive::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor
 		AEnemy* Enemy = Cast<AEnemy>(OtherActor);
 		if (MainCharacter || Enemy)
 		{
-			if (OverlapParticles)
+			UParticleSystem* Particles = UAssetStreamingSubsystem::Resolve(this, OverlapParticles);
+			if (Particles)
 			{
-				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), OverlapParticles, GetActorLocation(), FRotator(0.f), true);
+				AFXPool* FXPool = AFXPool::Get(this);
+				if (FXPool)
+				{
+					FXPool->SpawnEffect(Particles, GetActorLocation(), FRotator(0.f), EFXPriority::FXP_High);
+				}
 			}
-			if (OverlapSound)
+			USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, OverlapSound);
+			if (Sound)
 			{
-				UGameplayStatics::PlaySound2D(this, OverlapSound);
+				UGameplayStatics::PlaySound2D(this, Sound);
+			}
+			ADamageQueue* DamageQueue = ADamageQueue::Get(this);
+			if (DamageQueue)
+			{
+				DamageQueue->QueueDamage(OtherActor, Damage, nullptr, this, DamageTypeClass, GetActorLocation());
 			}
-			UGameplayStatics::ApplyDamage(OtherActor, Damage, nullptr, this, DamageTypeClass);
 			Destroy();
 		}
 	}
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FXPool.h"
+#include "WorldManagers.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+
+// Sets default values
+AFXPool::AFXPool()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	MaxActivePerSystem = 16;
+	MaxLowPrioritySpawnsPerFrame = 8;
+	MergeDistance = 50.f;
+	MaxLoopingLifetime = 5.f;
+
+	NumLive = 0;
+	NumPooled = 0;
+	NumSpawnedLastFrame = 0;
+	NumDroppedLastFrame = 0;
+
+	NumLowPrioritySpawnsThisFrame = 0;
+	NumSpawnedSinceTick = 0;
+	NumDroppedSinceTick = 0;
+}
+
+AFXPool* AFXPool::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<AFXPool>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called every frame
+void AFXPool::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	NumSpawnedLastFrame = NumSpawnedSinceTick;
+	NumDroppedLastFrame = NumDroppedSinceTick;
+	NumSpawnedSinceTick = 0;
+	NumDroppedSinceTick = 0;
+
+	NumLowPrioritySpawnsThisFrame = 0;
+	FrameSpawns.Reset();
+
+	// Stopped looping effects finish once their last particles die, OnEffectFinished pools them then
+	const float Now = GetWorld()->GetTimeSeconds();
+	for (auto It = LoopingStopTimes.CreateIterator(); It; ++It)
+	{
+		if (!IsValid(It->Key))
+		{
+			It.RemoveCurrent();
+		}
+		else if (Now >= It->Value)
+		{
+			It->Key->DeactivateSystem();
+			It.RemoveCurrent();
+		}
+	}
+
+	NumLive = 0;
+	NumPooled = 0;
+	for (const auto& Pool : Pools)
+	{
+		NumLive += Pool.Value.Active.Num();
+		NumPooled += Pool.Value.Free.Num();
+	}
+}
+
+UParticleSystemComponent* AFXPool::SpawnEffect(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, EFXPriority Priority)
+{
+	if (Template == nullptr) { return nullptr; }
+
+	const bool bLowPriority = Priority == EFXPriority::FXP_Low;
+
+	if (bLowPriority)
+	{
+		const float MergeDistanceSquared = FMath::Square(MergeDistance);
+		const bool bMerged = FrameSpawns.ContainsByPredicate([Template, &Location, MergeDistanceSquared](const TPair<UParticleSystem*, FVector>& Spawn)
+		{
+			return Spawn.Key == Template && FVector::DistSquared(Spawn.Value, Location) <= MergeDistanceSquared;
+		});
+
+		if (bMerged || NumLowPrioritySpawnsThisFrame >= MaxLowPrioritySpawnsPerFrame)
+		{
+			++NumDroppedSinceTick;
+			return nullptr;
+		}
+	}
+
+	FFXPoolEntry& Pool = Pools.FindOrAdd(Template);
+
+	UParticleSystemComponent* Component = nullptr;
+	if (Pool.Active.Num() >= MaxActivePerSystem)
+	{
+		if (bLowPriority)
+		{
+			++NumDroppedSinceTick;
+			return nullptr;
+		}
+
+		// Restart the oldest instance rather than going over the cap
+		Component = Pool.Active[0];
+		Pool.Active.RemoveAt(0);
+	}
+	else
+	{
+		while (Pool.Free.Num() > 0 && Component == nullptr)
+		{
+			Component = Pool.Free.Pop(false);
+			if (!IsValid(Component))
+			{
+				Component = nullptr;
+			}
+		}
+
+		if (Component == nullptr)
+		{
+			Component = CreateComponent(Template);
+		}
+	}
+
+	Component->SetWorldLocationAndRotation(Location, Rotation);
+	Component->ActivateSystem(true);
+	Pool.Active.Add(Component);
+
+	if (Template->IsLooping())
+	{
+		LoopingStopTimes.Add(Component, GetWorld()->GetTimeSeconds() + MaxLoopingLifetime);
+	}
+
+	FrameSpawns.Emplace(Template, Location);
+	if (bLowPriority)
+	{
+		++NumLowPrioritySpawnsThisFrame;
+	}
+	++NumSpawnedSinceTick;
+
+	return Component;
+}
+
+void AFXPool::OnEffectFinished(UParticleSystemComponent* Component)
+{
+	if (Component == nullptr) { return; }
+
+	LoopingStopTimes.Remove(Component);
+
+	FFXPoolEntry* Pool = Pools.Find(Component->Template);
+	if (Pool && Pool->Active.Remove(Component) > 0)
+	{
+		Pool->Free.Add(Component);
+	}
+}
+
+UParticleSystemComponent* AFXPool::CreateComponent(UParticleSystem* Template)
+{
+	UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(this);
+	Component->bAutoActivate = false;
+	Component->bAutoDestroy = false;
+	Component->SetAbsolute(true, true, true);
+	Component->SetTemplate(Template);
+	Component->SetupAttachment(RootComponent);
+	Component->OnSystemFinished.AddDynamic(this, &AFXPool::OnEffectFinished);
+	Component->RegisterComponent();
+	return Component;
+}
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "FXPool.generated.h"
+
+UENUM(BlueprintType)
+enum class EFXPriority : uint8
+{
+	FXP_Low			UMETA(DisplayName = "Low"),
+	FXP_High		UMETA(DisplayName = "High"),
+
+	FXP_MAX			UMETA(DisplayName = "DefaultMAX")
+};
+
+/** Particle components of one particle system */
+USTRUCT()
+struct FFXPoolEntry
+{
+	GENERATED_BODY()
+
+	/** Playing, oldest first */
+	UPROPERTY()
+	TArray<class UParticleSystemComponent*> Active;
+
+	/** Finished and ready to be played again */
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> Free;
+};
+
+/**
+ * Pooled one-shot particle effects, keyed by particle system.
+ * Components are recycled once their system completes instead of being spawned for every hit,
+ * each system has a cap on playing instances and low priority effects are dropped
+ * when the frame's spawn budget runs out or an identical effect already started close by.
+ * Looping systems never complete on their own, they are stopped after MaxLoopingLifetime and recycled once their particles are gone.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API AFXPool : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AFXPool();
+
+	static AFXPool* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** Instances of one system allowed to play at once, high priority effects recycle the oldest */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FX Pool")
+	int32 MaxActivePerSystem;
+
+	/** Low priority effects started per frame, the rest are dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FX Pool")
+	int32 MaxLowPrioritySpawnsPerFrame;
+
+	/** Low priority effects this close to one of the same system started this frame are merged into it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FX Pool")
+	float MergeDistance;
+
+	/** Seconds a looping system plays before it stops spawning particles */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FX Pool")
+	float MaxLoopingLifetime;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "FX Pool | Stats")
+	int32 NumLive;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "FX Pool | Stats")
+	int32 NumPooled;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "FX Pool | Stats")
+	int32 NumSpawnedLastFrame;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "FX Pool | Stats")
+	int32 NumDroppedLastFrame;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	/** Play Template at Location, returns null if the effect was dropped */
+	UParticleSystemComponent* SpawnEffect(class UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, EFXPriority Priority = EFXPriority::FXP_Low);
+
+private:
+	UFUNCTION()
+	void OnEffectFinished(UParticleSystemComponent* Component);
+
+	UParticleSystemComponent* CreateComponent(UParticleSystem* Template);
+
+	UPROPERTY()
+	TMap<UParticleSystem*, FFXPoolEntry> Pools;
+
+	/** World time each playing looping effect is stopped at */
+	TMap<UParticleSystemComponent*, float> LoopingStopTimes;
+
+	/** Effects started this frame, for merging */
+	TArray<TPair<UParticleSystem*, FVector>> FrameSpawns;
+
+	int32 NumLowPrioritySpawnsThisFrame;
+
+	/** Spawns can happen before this manager ticks, so counts are collected here and published in Tick */
+	int32 NumSpawnedSinceTick;
+	int32 NumDroppedSinceTick;
+};
@@ -10,4 +10,11 @@ UFirstSaveGame::UFirstSaveGame()
 
 	CharacterStats.WeaponName = TEXT("");
 	CharacterStats.LevelName = TEXT("");
-}
\ No newline at end of file
+	CharacterStats.PlayTime = 0.f;
+}
+UWorldStateSaveGame::UWorldStateSaveGame()
+{
+	LevelName = TEXT("");
+	BaselineChecksum = 0;
+	PlatformTime = 0.f;
+}
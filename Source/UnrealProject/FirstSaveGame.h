@@ -37,6 +37,51 @@ struct FCharacterStats
 
 	UPROPERTY(VisibleAnywhere, Category = "SaveGameData")
 	FRotator Rotation;
+
+	/** Seconds played in total */
+	UPROPERTY(VisibleAnywhere, Category = "SaveGameData")
+	float PlayTime;
+};
+
+/** What a save menu shows about a slot, kept apart from the slot itself */
+USTRUCT(BlueprintType)
+struct FSaveSlotInfo
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "SaveSlot")
+	FString SlotName;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "SaveSlot")
+	FString LevelName;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "SaveSlot")
+	float PlayTime;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "SaveSlot")
+	int32 Coins;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "SaveSlot")
+	FString WeaponName;
+
+	/** When the slot was written, in UTC */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "SaveSlot")
+	FDateTime Timestamp;
+
+	/** CRC and size of the slot file, checked to spot a corrupt or half written slot */
+	UPROPERTY(VisibleAnywhere, Category = "SaveSlot")
+	uint32 Checksum;
+
+	UPROPERTY(VisibleAnywhere, Category = "SaveSlot")
+	int32 Size;
+
+	FSaveSlotInfo()
+	{
+		PlayTime = 0.f;
+		Coins = 0;
+		Checksum = 0;
+		Size = 0;
+	}
 };
 
 UCLASS()
@@ -56,3 +101,39 @@ public:
 	UPROPERTY(VisibleAnywhere, Category = "Basic")
 	FCharacterStats CharacterStats;
 };
+
+/** Changes to one level's placed actors, saved to a slot of its own so untouched levels are never rewritten */
+UCLASS()
+class UNREALPROJECT_API UWorldStateSaveGame : public USaveGame
+{
+	GENERATED_BODY()
+
+public:
+	UWorldStateSaveGame();
+
+	UPROPERTY(VisibleAnywhere, Category = "Basic")
+	FString LevelName;
+
+	/** Checksum of the level's tracked actors, a save made against a different layout is ignored */
+	UPROPERTY(VisibleAnywhere, Category = "Basic")
+	uint32 BaselineChecksum;
+
+	/** One bit per tracked actor in stable ID order, set once it differs from how the level placed it */
+	UPROPERTY(VisibleAnywhere, Category = "Basic")
+	TArray<uint8> ChangedBits;
+
+	/** Time the level's floating platforms were at, each one's location follows from it */
+	UPROPERTY(VisibleAnywhere, Category = "Basic")
+	float PlatformTime;
+};
+
+/** Info on every save slot, small enough to read whenever a menu opens */
+UCLASS()
+class UNREALPROJECT_API USaveSlotIndex : public USaveGame
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, Category = "Basic")
+	TArray<FSaveSlotInfo> Slots;
+};
@@ -2,8 +2,49 @@
 
 
 #include "FloatingPlatform.h"
-#include "TimerManager.h"
+#include "BatchTickManager.h"
+#include "WorldStateManager.h"
 #include "Components/StaticMeshComponent.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+
+FVector FPlatformMotion::Evaluate(float Time, bool& bOutMoving) const
+{
+	bOutMoving = false;
+
+	const float HalfPeriod = MoveTime + PauseTime;
+	if (MoveTime <= 0.f) { return StartPoint; }
+
+	float Phase = FMath::Fmod(Time, 2.f * HalfPeriod);
+	if (Phase < 0.f)
+	{
+		Phase += 2.f * HalfPeriod;
+	}
+
+	// The second half of the period is the way back
+	const bool bReturning = Phase >= HalfPeriod;
+	if (bReturning)
+	{
+		Phase -= HalfPeriod;
+	}
+	const FVector& From = bReturning ? EndPoint : StartPoint;
+	const FVector& To = bReturning ? StartPoint : EndPoint;
+
+	if (Phase < PauseTime) { return From; }
+
+	bOutMoving = true;
+	const float Alpha = (Phase - PauseTime) / MoveTime;
+	if (EaseCurve)
+	{
+		return FMath::Lerp(From, To, EaseCurve->GetFloatValue(Alpha));
+	}
+	if (EaseExponent <= KINDA_SMALL_NUMBER)
+	{
+		return FMath::Lerp(From, To, Alpha);
+	}
+	return FMath::Lerp(From, To, (1.f - FMath::Exp(-EaseExponent * Alpha)) / (1.f - FMath::Exp(-EaseExponent)));
+}
 
 // Sets default values
 AFloatingPlatform::AFloatingPlatform()
@@ -21,6 +62,11 @@ AFloatingPlatform::AFloatingPlatform()
 
 	InterpSpeed = 4.f;
 	InterpTime = 1.f;
+	MoveTime = 0.f;
+	EaseCurve = nullptr;
+
+	Distance = 0.f;
+	BatchTickId = INDEX_NONE;
 }
 
 // Called when the game starts or when spawned
@@ -31,11 +77,39 @@ void AFloatingPlatform::BeginPlay()
 	StartPoint = GetActorLocation();
 	EndPoint += StartPoint;
 
+	Distance = (EndPoint - StartPoint).Size();
+
+	Motion.StartPoint = StartPoint;
+	Motion.EndPoint = EndPoint;
+	Motion.PauseTime = FMath::Max(InterpTime, 0.f);
+	Motion.EaseCurve = EaseCurve;
+
+	// Easing in at InterpSpeed leaves exp(-InterpSpeed * t) of the distance, the old interpolation stopped 1 unit short
+	Motion.EaseExponent = FMath::Loge(FMath::Max(Distance, 1.f));
+	Motion.MoveTime = MoveTime > 0.f ? MoveTime : Motion.EaseExponent / FMath::Max(InterpSpeed, KINDA_SMALL_NUMBER);
+
+	// A platform streamed in or spawned later starts wherever the time puts it
 	bInterping = false;
+	SetActorLocation(Motion.Evaluate(GetMotionTime(GetWorld()), bInterping));
 
-	GetWorldTimerManager().SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
+	// The batch tick manager moves every platform in one loop
+	ABatchTickManager* BatchTickManager = ABatchTickManager::Get(this);
+	if (BatchTickManager && ABatchTickManager::CanBatchTick(this))
+	{
+		BatchTickManager->RegisterPlatform(this);
+		SetActorTickEnabled(false);
+	}
+}
 
-	Distance = (EndPoint - StartPoint).Size();
+void AFloatingPlatform::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ABatchTickManager* BatchTickManager = ABatchTickManager::Get(this, false);
+	if (BatchTickManager)
+	{
+		BatchTickManager->UnregisterPlatform(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -43,31 +117,28 @@ void AFloatingPlatform::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	if (bInterping)
+	bool bMoving = false;
+	const FVector Location = Motion.Evaluate(GetMotionTime(GetWorld()), bMoving);
+
+	// Waiting at an end the location doesn't change, it only has to be set once on arriving
+	if (bMoving || bInterping)
 	{
-		FVector CurrentLocation = GetActorLocation();
-		FVector Interp = FMath::VInterpTo(CurrentLocation, EndPoint, DeltaTime, InterpSpeed);
-		SetActorLocation(Interp);
-
-		float DistanceTravelled = (GetActorLocation() - StartPoint).Size();
-		if ((Distance - DistanceTravelled) <= 1.f)
-		{
-			ToggleInterping();
-			GetWorldTimerManager().SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
-			SwapVectors(StartPoint, EndPoint);
-		}
-	}	
+		SetActorLocation(Location);
+	}
+	bInterping = bMoving;
 }
 
-void AFloatingPlatform::ToggleInterping()
+FVector AFloatingPlatform::GetLocationAtTime(float Time) const
 {
-	bInterping = !bInterping;
+	bool bMoving = false;
+	return Motion.Evaluate(Time, bMoving);
 }
 
-void AFloatingPlatform::SwapVectors(FVector& V1, FVector& V2)
+float AFloatingPlatform::GetMotionTime(const UWorld* World)
 {
-	FVector Temp = V1;
-	V1 = V2;
-	V2 = Temp;
-}
+	const AGameStateBase* GameState = World->GetGameState();
+	const float Time = GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
 
+	const AWorldStateManager* WorldStateManager = AWorldStateManager::Get(World, false);
+	return WorldStateManager ? Time + WorldStateManager->GetPlatformTimeOffset() : Time;
+}
@@ -6,6 +6,41 @@
 #include "GameFramework/Actor.h"
 #include "FloatingPlatform.generated.h"
 
+/**
+ * Back and forth between two points as a pure function of time: wait at StartPoint, move to EndPoint, wait there, move back.
+ * The same time always gives the same location, so it never drifts and can be evaluated for any moment.
+ */
+struct FPlatformMotion
+{
+	FVector StartPoint;
+	FVector EndPoint;
+
+	/** Seconds one way takes */
+	float MoveTime;
+
+	/** Seconds waited at each end */
+	float PauseTime;
+
+	/** Steepness of the default exponential ease out, 0 moves linearly */
+	float EaseExponent;
+
+	/** Replaces the default ease when set, maps 0..1 of the way's time to 0..1 of its distance */
+	const class UCurveFloat* EaseCurve;
+
+	FPlatformMotion()
+	{
+		StartPoint = FVector::ZeroVector;
+		EndPoint = FVector::ZeroVector;
+		MoveTime = 0.f;
+		PauseTime = 0.f;
+		EaseExponent = 0.f;
+		EaseCurve = nullptr;
+	}
+
+	/** Location at Time, bOutMoving is false while waiting at either end */
+	FVector Evaluate(float Time, bool& bOutMoving) const;
+};
+
 UCLASS()
 class UNREALPROJECT_API AFloatingPlatform : public AActor
 {
@@ -25,28 +60,47 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Platform", Meta = (MakeEditWidget = "true"))
 	FVector EndPoint;
 
+	/** How fast the platform eases into the end point, used to work out MoveTime when it isn't set */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
 	float InterpSpeed;
 
+	/** Seconds waited at each end */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
 	float InterpTime;
 
+	/** Seconds one way takes, 0 takes as long as easing in at InterpSpeed until 1 unit short of the end */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
-	bool bInterping;
+	float MoveTime;
 
-	FTimerHandle InterpTimer;
+	/** Optional ease over one way, 0..1 of the time to 0..1 of the distance. Without it the platform eases out like it did at InterpSpeed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
+	class UCurveFloat* EaseCurve;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
+	bool bInterping;
 
 	float Distance;
 
+	/** Slot in the batch tick manager, INDEX_NONE while the platform moves itself */
+	int32 BatchTickId;
+
+	/** Worked out in BeginPlay, fixed after */
+	FPlatformMotion Motion;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	void ToggleInterping();
+	/** Where the platform is at Time, in the same time GetMotionTime() gives */
+	UFUNCTION(BlueprintCallable, Category = "Platform")
+	FVector GetLocationAtTime(float Time) const;
 
-	void SwapVectors(FVector& V1, FVector& V2);
+	/** Time platforms are evaluated at, the server's world time so every machine sees them in the same place, shifted by a loaded save */
+	static float GetMotionTime(const UWorld* World);
 };
@@ -2,6 +2,8 @@
 
 
 #include "FloorSwitch.h"
+#include "WorldStateManager.h"
+#include "MainCharacter.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/BoxComponent.h"
 #include "TimerManager.h"
@@ -10,7 +12,7 @@
 AFloorSwitch::AFloorSwitch()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	TriggerBox = CreateDefaultSubobject<UBoxComponent>(TEXT("TriggerBox"));
 	RootComponent = TriggerBox;
@@ -31,6 +33,7 @@ AFloorSwitch::AFloorSwitch()
 	SwitchTime = 2.f;
 
 	bCharacterOnSwitch = false;
+	bHasBeenTriggered = false;
 }
 
 // Called when the game starts or when spawned
@@ -43,6 +46,12 @@ void AFloorSwitch::BeginPlay()
 
 	InitialDoorLocation = Door->GetComponentLocation();
 	InitialSwitchLocation = FloorSwitch->GetComponentLocation();
+
+	// Opened in a save loaded before the switch began play
+	if (bHasBeenTriggered)
+	{
+		RaiseDoor();
+	}
 }
 
 // Called every frame
@@ -55,6 +64,24 @@ void AFloorSwitch::Tick(float DeltaTime)
 void AFloorSwitch::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
 	if (!bCharacterOnSwitch) { bCharacterOnSwitch = true; }
+
+	AMainCharacter* MainCharacter = Cast<AMainCharacter>(OtherActor);
+	if (MainCharacter)
+	{
+		MainCharacter->CaptureCheckpoint();
+	}
+
+	if (!bHasBeenTriggered)
+	{
+		bHasBeenTriggered = true;
+
+		AWorldStateManager* WorldStateManager = AWorldStateManager::Get(this, false);
+		if (WorldStateManager)
+		{
+			WorldStateManager->MarkChanged(this);
+		}
+	}
+
 	RaiseDoor();
 	LowerFloorSwitch();
 }
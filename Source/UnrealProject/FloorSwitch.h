@@ -42,6 +42,10 @@ public:
 
 	bool bCharacterOnSwitch;
 
+	/** Stepped on at least once, kept in the world state save */
+	UPROPERTY(BlueprintReadOnly, Category = "Floor Switch")
+	bool bHasBeenTriggered;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
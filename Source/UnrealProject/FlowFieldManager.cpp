@@ -0,0 +1,298 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlowFieldManager.h"
+#include "WorldManagers.h"
+#include "NavigationSystem.h"
+
+namespace FlowField
+{
+	/** Neighbour offsets, each direction's opposite is at Index ^ 1 */
+	static const FIntPoint Offsets[8] =
+	{
+		FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1),
+		FIntPoint(1, 1), FIntPoint(-1, -1), FIntPoint(1, -1), FIntPoint(-1, 1)
+	};
+
+	static const float Costs[8] = { 1.f, 1.f, 1.f, 1.f, 1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f };
+
+	struct FOpenCell
+	{
+		float Cost;
+		int32 Index;
+
+		bool operator<(const FOpenCell& Other) const { return Cost < Other.Cost; }
+	};
+}
+
+// Sets default values
+AFlowFieldManager::AFlowFieldManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	CellSize = 100.f;
+	GridDimension = 48;
+	MaxStepHeight = 60.f;
+	LayerHeight = 400.f;
+	MaxCachedCells = 32768;
+	MaxProjectionsPerFrame = 256;
+	FieldTimeout = 5.f;
+
+	NumFields = 0;
+	NumCachedCells = 0;
+	NumRebuildsLastFrame = 0;
+}
+
+AFlowFieldManager* AFlowFieldManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<AFlowFieldManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called every frame
+void AFlowFieldManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	NumRebuildsLastFrame = 0;
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	int32 ProjectionBudget = MaxProjectionsPerFrame;
+
+	for (auto It = Fields.CreateIterator(); It; ++It)
+	{
+		FFlowField& Field = It->Value;
+		AActor* Target = Field.Target.Get();
+		if (Target == nullptr || Now - Field.LastRequestTime > FieldTimeout)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		const FVector TargetLocation = Target->GetActorLocation();
+		const FIntPoint GoalCell = GetCell(TargetLocation);
+		const int32 Layer = GetLayer(TargetLocation.Z);
+		if (GoalCell != Field.PendingGoalCell || Layer != Field.PendingLayer || !Field.bValid)
+		{
+			// Only re-centre once the goal drifts towards the edge, so most moves reuse the same window
+			const int32 Margin = GridDimension / 4;
+			const FIntPoint Local = GoalCell - Field.Origin;
+			if (!Field.bValid || Local.X < Margin || Local.Y < Margin || Local.X >= GridDimension - Margin || Local.Y >= GridDimension - Margin)
+			{
+				Field.PendingOrigin = GoalCell - FIntPoint(GridDimension / 2, GridDimension / 2);
+			}
+			Field.PendingGoalCell = GoalCell;
+			Field.PendingLayer = Layer;
+			Field.bDirty = true;
+		}
+
+		if (Field.bDirty && DiscoverCells(Field, ProjectionBudget))
+		{
+			Integrate(Field);
+			++NumRebuildsLastFrame;
+		}
+	}
+
+	if (CellHeights.Num() > MaxCachedCells)
+	{
+		TrimCellHeights();
+	}
+
+	NumFields = Fields.Num();
+	NumCachedCells = CellHeights.Num();
+}
+
+bool AFlowFieldManager::GetFlowDirection(AActor* Target, const FVector& Location, FVector& OutDirection)
+{
+	if (Target == nullptr) { return false; }
+
+	FFlowField* Field = Fields.Find(Target);
+	if (Field == nullptr)
+	{
+		Field = &Fields.Add(Target);
+		Field->Target = Target;
+		Field->Origin = FIntPoint::ZeroValue;
+		Field->GoalCell = FIntPoint::ZeroValue;
+		Field->Layer = 0;
+		Field->PendingOrigin = FIntPoint::ZeroValue;
+		Field->PendingGoalCell = FIntPoint::ZeroValue;
+		Field->PendingLayer = 0;
+		Field->bValid = false;
+		Field->bDirty = true;
+	}
+	Field->LastRequestTime = GetWorld()->GetTimeSeconds();
+
+	if (!Field->bValid) { return false; }
+
+	// The field only covers the target's layer, enemies on another floor have to path there
+	if (GetLayer(Location.Z) != Field->Layer) { return false; }
+
+	const FIntPoint Cell = GetCell(Location);
+	const FIntPoint Local = Cell - Field->Origin;
+	if (Local.X < 0 || Local.Y < 0 || Local.X >= GridDimension || Local.Y >= GridDimension) { return false; }
+
+	const int32 Index = Local.Y * GridDimension + Local.X;
+	if (Field->Integration[Index] == MAX_flt) { return false; }
+
+	FVector Goal;
+	const int8 Direction = Field->Direction[Index];
+	if (Direction == INDEX_NONE)
+	{
+		Goal = Target->GetActorLocation();
+	}
+	else
+	{
+		Goal = GetCellCenter(Cell + FlowField::Offsets[Direction], Location.Z);
+	}
+
+	OutDirection = (Goal - Location).GetSafeNormal2D();
+	return !OutDirection.IsNearlyZero();
+}
+
+FIntPoint AFlowFieldManager::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+FVector AFlowFieldManager::GetCellCenter(const FIntPoint& Cell, float Z) const
+{
+	return FVector((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize, Z);
+}
+
+int32 AFlowFieldManager::GetLayer(float Z) const
+{
+	return FMath::FloorToInt(Z / LayerHeight);
+}
+
+bool AFlowFieldManager::DiscoverCells(const FFlowField& Field, int32& ProjectionBudget)
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (NavSys == nullptr) { return false; }
+
+	const FVector Extent(CellSize * 0.5f, CellSize * 0.5f, 500.f);
+	const float LayerZ = (Field.PendingLayer + 0.5f) * LayerHeight;
+	bool bComplete = true;
+
+	for (int32 Y = 0; Y < GridDimension; Y++)
+	{
+		for (int32 X = 0; X < GridDimension; X++)
+		{
+			const FIntPoint Cell = Field.PendingOrigin + FIntPoint(X, Y);
+			const FIntVector Key(Cell.X, Cell.Y, Field.PendingLayer);
+			if (CellHeights.Contains(Key)) { continue; }
+
+			if (ProjectionBudget <= 0)
+			{
+				bComplete = false;
+				continue;
+			}
+			--ProjectionBudget;
+
+			FNavLocation NavLocation;
+			if (NavSys->ProjectPointToNavigation(GetCellCenter(Cell, LayerZ), NavLocation, Extent))
+			{
+				CellHeights.Add(Key, NavLocation.Location.Z);
+			}
+			else
+			{
+				CellHeights.Add(Key, MAX_flt);
+			}
+		}
+	}
+
+	return bComplete;
+}
+
+void AFlowFieldManager::Integrate(FFlowField& Field)
+{
+	Field.Origin = Field.PendingOrigin;
+	Field.GoalCell = Field.PendingGoalCell;
+	Field.Layer = Field.PendingLayer;
+
+	const int32 NumCells = GridDimension * GridDimension;
+	Field.Integration.Init(MAX_flt, NumCells);
+	Field.Direction.Init(INDEX_NONE, NumCells);
+
+	// Heights copied out of the cache so the search below does no hashing
+	TArray<float> Heights;
+	Heights.SetNumUninitialized(NumCells);
+	for (int32 Index = 0; Index < NumCells; Index++)
+	{
+		const FIntPoint Cell = Field.Origin + FIntPoint(Index % GridDimension, Index / GridDimension);
+		const float* Height = CellHeights.Find(FIntVector(Cell.X, Cell.Y, Field.Layer));
+		Heights[Index] = Height ? *Height : MAX_flt;
+	}
+
+	const FIntPoint GoalLocal = Field.GoalCell - Field.Origin;
+	const int32 GoalIndex = GoalLocal.Y * GridDimension + GoalLocal.X;
+
+	TArray<FlowField::FOpenCell> Open;
+	Open.HeapPush(FlowField::FOpenCell{ 0.f, GoalIndex });
+	Field.Integration[GoalIndex] = 0.f;
+
+	auto IsWalkable = [&](int32 X, int32 Y)
+	{
+		return X >= 0 && Y >= 0 && X < GridDimension && Y < GridDimension && Heights[Y * GridDimension + X] != MAX_flt;
+	};
+
+	while (Open.Num() > 0)
+	{
+		FlowField::FOpenCell Current;
+		Open.HeapPop(Current);
+		if (Current.Cost > Field.Integration[Current.Index]) { continue; }
+
+		const int32 CX = Current.Index % GridDimension;
+		const int32 CY = Current.Index / GridDimension;
+
+		for (int32 D = 0; D < 8; D++)
+		{
+			const int32 NX = CX + FlowField::Offsets[D].X;
+			const int32 NY = CY + FlowField::Offsets[D].Y;
+			if (!IsWalkable(NX, NY)) { continue; }
+
+			// No cutting corners past blocked cells
+			if (D >= 4 && (!IsWalkable(NX, CY) || !IsWalkable(CX, NY))) { continue; }
+
+			const int32 Neighbour = NY * GridDimension + NX;
+
+			// The goal may be off the navmesh (player jumping, standing on a prop), so it has no height to compare
+			if (Heights[Current.Index] != MAX_flt && FMath::Abs(Heights[Neighbour] - Heights[Current.Index]) > MaxStepHeight) { continue; }
+
+			const float Cost = Current.Cost + FlowField::Costs[D];
+			if (Cost < Field.Integration[Neighbour])
+			{
+				Field.Integration[Neighbour] = Cost;
+				Field.Direction[Neighbour] = D ^ 1;
+				Open.HeapPush(FlowField::FOpenCell{ Cost, Neighbour });
+			}
+		}
+	}
+
+	Field.bValid = true;
+	Field.bDirty = false;
+}
+
+void AFlowFieldManager::TrimCellHeights()
+{
+	// Fields being discovered need their cells again next frame, everything else is cheap to project again later
+	for (auto It = CellHeights.CreateIterator(); It; ++It)
+	{
+		const FIntVector& Key = It->Key;
+		bool bInUse = false;
+		for (const TPair<TWeakObjectPtr<AActor>, FFlowField>& Pair : Fields)
+		{
+			const FFlowField& Field = Pair.Value;
+			const FIntPoint Local = FIntPoint(Key.X, Key.Y) - Field.PendingOrigin;
+			if (Key.Z == Field.PendingLayer && Local.X >= 0 && Local.Y >= 0 && Local.X < GridDimension && Local.Y < GridDimension)
+			{
+				bInUse = true;
+				break;
+			}
+		}
+		if (!bInUse)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "FlowFieldManager.generated.h"
+
+/** Integration field around one chase target, all enemies chasing it share this */
+struct FFlowField
+{
+	TWeakObjectPtr<AActor> Target;
+
+	/** World cell of the grid's lower corner */
+	FIntPoint Origin;
+
+	/** World cell the target stood in when the field was integrated */
+	FIntPoint GoalCell;
+
+	/** Height layer the target stood in, cells are projected from the middle of it */
+	int32 Layer;
+
+	/** Window, goal and layer the next rebuild will use, applied once all their cells are discovered */
+	FIntPoint PendingOrigin;
+	FIntPoint PendingGoalCell;
+	int32 PendingLayer;
+
+	/** Cost to reach the goal from each cell, MAX_flt when unreachable */
+	TArray<float> Integration;
+
+	/** Index into the neighbour table of the next cell towards the goal, INDEX_NONE at the goal or when unreachable */
+	TArray<int8> Direction;
+
+	bool bValid;
+	bool bDirty;
+
+	float LastRequestTime;
+};
+
+/**
+ * Shared flow-field navigation for enemies chasing the same target.
+ * Walkability comes from projecting grid cells onto the navmesh and is cached per cell and height layer,
+ * so floors above each other don't share heights. The integration field is only rebuilt when the target enters a new cell,
+ * so cost scales with the grid area rather than with the number of chasing enemies.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API AFlowFieldManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AFlowFieldManager();
+
+	static AFlowFieldManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flow Field")
+	float CellSize;
+
+	/** Number of cells along each side of the grid centred on the target */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flow Field")
+	int32 GridDimension;
+
+	/** Largest height difference between neighbouring cells that can still be walked */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flow Field")
+	float MaxStepHeight;
+
+	/** Height of one layer of cells, keep it below twice the projection's 500 unit reach so every floor is found */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flow Field")
+	float LayerHeight;
+
+	/** Cached cells kept before the ones outside every field's window are dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flow Field")
+	int32 MaxCachedCells;
+
+	/** Navmesh projections allowed per frame while new cells are discovered */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flow Field")
+	int32 MaxProjectionsPerFrame;
+
+	/** Fields nobody sampled for this long are dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flow Field")
+	float FieldTimeout;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Flow Field | Stats")
+	int32 NumFields;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Flow Field | Stats")
+	int32 NumCachedCells;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Flow Field | Stats")
+	int32 NumRebuildsLastFrame;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Steering direction towards Target from Location.
+	 * Returns false if the field is still being built or Location is off the grid or on another layer than Target,
+	 * callers should fall back to regular pathfinding in that case.
+	 */
+	bool GetFlowDirection(AActor* Target, const FVector& Location, FVector& OutDirection);
+
+private:
+	FIntPoint GetCell(const FVector& Location) const;
+
+	FVector GetCellCenter(const FIntPoint& Cell, float Z) const;
+
+	int32 GetLayer(float Z) const;
+
+	/** Projects unknown cells of the field's grid onto the navmesh, returns true once every cell is known */
+	bool DiscoverCells(const FFlowField& Field, int32& ProjectionBudget);
+
+	void Integrate(FFlowField& Field);
+
+	/** Drop cached cells no field's next window uses */
+	void TrimCellHeights();
+
+	/** Navmesh height of every discovered cell, keyed by cell and layer, unwalkable cells store MAX_flt */
+	TMap<FIntVector, float> CellHeights;
+
+	TMap<TWeakObjectPtr<AActor>, FFlowField> Fields;
+};
@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HordeManager.h"
+#include "WorldManagers.h"
+#include "EnemyPool.h"
+#include "MainCharacter.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "NavigationSystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Async/ParallelFor.h"
+
+// Sets default values
+AHordeManager::AHordeManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	PromoteDistance = 3000.f;
+	DemoteDistance = 4500.f;
+	MaxPromotionsPerFrame = 4;
+	PromotionProjectionExtent = FVector(200.f, 200.f, 500.f);
+	MaxDemotionsPerFrame = 4;
+
+	NumAgents = 0;
+	NumPromotedEnemies = 0;
+	NumPromotionsLastFrame = 0;
+	NumDemotionsLastFrame = 0;
+	SimulationTimeMs = 0.f;
+}
+
+AHordeManager* AHordeManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<AHordeManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called every frame
+void AHordeManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	NumPromotionsLastFrame = 0;
+	NumDemotionsLastFrame = 0;
+
+	AMainCharacter* Player = Cast<AMainCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+
+	const double StartTime = FPlatformTime::Seconds();
+	Simulate(DeltaTime, Player);
+	SimulationTimeMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	if (Player)
+	{
+		PromoteAgents(Player);
+		DemoteEnemies(Player);
+	}
+
+	NumAgents = 0;
+	for (int32 b = 0; b < Buckets.Num(); b++)
+	{
+		FHordeBucket& Bucket = Buckets[b];
+		NumAgents += Bucket.Num();
+
+		UInstancedStaticMeshComponent* Mesh = BucketMeshes[b];
+		if (Mesh && Bucket.Num() > 0)
+		{
+			// Instances aren't tied to agents, every instance is rewritten each frame so only the count has to match
+			Mesh->BatchUpdateInstancesTransforms(0, Bucket.InstanceTransforms, true, true, true);
+		}
+	}
+	NumPromotedEnemies = PromotedEnemies.Num();
+}
+
+void AHordeManager::AddAgent(TSubclassOf<AEnemy> Class, const FVector& Location, float Health, EEnemyMovementStatus Status)
+{
+	if (Class == nullptr) { return; }
+
+	const int32 BucketIndex = FindOrAddBucket(Class);
+	FHordeBucket& Bucket = Buckets[BucketIndex];
+
+	Bucket.Positions.Add(Location);
+	Bucket.Velocities.Add(FVector::ZeroVector);
+	Bucket.Healths.Add(Health > 0.f ? Health : Class->GetDefaultObject<AEnemy>()->Health);
+	Bucket.States.Add(Status);
+	Bucket.Targets.Add(INDEX_NONE);
+	Bucket.WantsPromotion.Add(false);
+	Bucket.InstanceTransforms.Add(FTransform(Location - FVector(0.f, 0.f, Bucket.HalfHeight)));
+
+	if (BucketMeshes[BucketIndex])
+	{
+		BucketMeshes[BucketIndex]->AddInstanceWorldSpace(Bucket.InstanceTransforms.Last());
+	}
+}
+
+int32 AHordeManager::FindOrAddBucket(UClass* Class)
+{
+	int32 BucketIndex = BucketClasses.Find(Class);
+	if (BucketIndex != INDEX_NONE) { return BucketIndex; }
+
+	const AEnemy* Defaults = Class->GetDefaultObject<AEnemy>();
+
+	FHordeBucket& Bucket = Buckets.AddDefaulted_GetRef();
+	Bucket.Speed = Defaults->GetCharacterMovement()->MaxWalkSpeed;
+	Bucket.HalfHeight = Defaults->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	Bucket.AgroRadius = Defaults->AgroSphere->GetScaledSphereRadius();
+
+	UInstancedStaticMeshComponent* Mesh = nullptr;
+	if (Defaults->HordeMesh)
+	{
+		Mesh = NewObject<UInstancedStaticMeshComponent>(this);
+		Mesh->SetStaticMesh(Defaults->HordeMesh);
+		Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Mesh->SetCastShadow(false);
+		Mesh->SetupAttachment(RootComponent);
+		Mesh->RegisterComponent();
+	}
+
+	BucketClasses.Add(Class);
+	BucketMeshes.Add(Mesh);
+
+	return Buckets.Num() - 1;
+}
+
+void AHordeManager::RemoveAgent(int32 BucketIndex, int32 AgentIndex)
+{
+	FHordeBucket& Bucket = Buckets[BucketIndex];
+	Bucket.Positions.RemoveAtSwap(AgentIndex);
+	Bucket.Velocities.RemoveAtSwap(AgentIndex);
+	Bucket.Healths.RemoveAtSwap(AgentIndex);
+	Bucket.States.RemoveAtSwap(AgentIndex);
+	Bucket.Targets.RemoveAtSwap(AgentIndex);
+	Bucket.WantsPromotion.RemoveAtSwap(AgentIndex);
+	Bucket.InstanceTransforms.RemoveAtSwap(AgentIndex);
+
+	UInstancedStaticMeshComponent* Mesh = BucketMeshes[BucketIndex];
+	if (Mesh && Mesh->GetInstanceCount() > 0)
+	{
+		Mesh->RemoveInstance(Mesh->GetInstanceCount() - 1);
+	}
+}
+
+void AHordeManager::Simulate(float DeltaTime, const AMainCharacter* Player)
+{
+	const bool bHasPlayer = Player != nullptr;
+	const FVector PlayerLocation = bHasPlayer ? Player->GetActorLocation() : FVector::ZeroVector;
+	const float PromoteDistanceSquared = FMath::Square(PromoteDistance);
+
+	for (FHordeBucket& Bucket : Buckets)
+	{
+		const float AgroRadiusSquared = FMath::Square(Bucket.AgroRadius);
+
+		// Each agent only writes its own slots, so the bucket can be split across worker threads
+		ParallelFor(Bucket.Num(), [&Bucket, bHasPlayer, PlayerLocation, AgroRadiusSquared, PromoteDistanceSquared, DeltaTime](int32 i)
+		{
+			if (Bucket.States[i] == EEnemyMovementStatus::EMS_Dead) { return; }
+
+			FVector& Position = Bucket.Positions[i];
+			FVector& Velocity = Bucket.Velocities[i];
+
+			const FVector ToPlayer = PlayerLocation - Position;
+			const float DistanceSquared = ToPlayer.SizeSquared2D();
+
+			// Same rule as AgroRangeBegin/End on the actor, so an enemy behaves the same in both forms
+			if (bHasPlayer && ToPlayer.SizeSquared() <= AgroRadiusSquared)
+			{
+				Bucket.States[i] = EEnemyMovementStatus::EMS_MoveToTarget;
+				Bucket.Targets[i] = 0;
+				Velocity = ToPlayer.GetSafeNormal2D() * Bucket.Speed;
+			}
+			else
+			{
+				Bucket.States[i] = EEnemyMovementStatus::EMS_Idle;
+				Bucket.Targets[i] = INDEX_NONE;
+				Velocity = FVector::ZeroVector;
+			}
+
+			Position += Velocity * DeltaTime;
+			Bucket.WantsPromotion[i] = bHasPlayer && DistanceSquared <= PromoteDistanceSquared;
+
+			FTransform& Transform = Bucket.InstanceTransforms[i];
+			Transform.SetLocation(Position - FVector(0.f, 0.f, Bucket.HalfHeight));
+			if (!Velocity.IsNearlyZero())
+			{
+				Transform.SetRotation(Velocity.ToOrientationQuat());
+			}
+		});
+	}
+}
+
+void AHordeManager::PromoteAgents(AMainCharacter* Player)
+{
+	AEnemyPool* EnemyPool = AEnemyPool::Get(this);
+	if (EnemyPool == nullptr) { return; }
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	for (int32 b = 0; b < Buckets.Num(); b++)
+	{
+		FHordeBucket& Bucket = Buckets[b];
+		for (int32 i = Bucket.Num() - 1; i >= 0 && NumPromotionsLastFrame < MaxPromotionsPerFrame; i--)
+		{
+			if (!Bucket.WantsPromotion[i]) { continue; }
+
+			// Agents move in a straight line through walls and over gaps, the enemy comes out on the navmesh next to them
+			FVector Location = Bucket.Positions[i];
+			FNavLocation NavLocation;
+			if (NavSys && NavSys->ProjectPointToNavigation(Location, NavLocation, PromotionProjectionExtent))
+			{
+				Location = NavLocation.Location + FVector(0.f, 0.f, Bucket.HalfHeight);
+			}
+
+			const FRotator Rotation = Bucket.Velocities[i].IsNearlyZero() ? FRotator(0.f) : Bucket.Velocities[i].Rotation();
+			AEnemy* Enemy = EnemyPool->Acquire(BucketClasses[b], Location, Rotation);
+			if (Enemy == nullptr) { continue; }
+
+			Enemy->Health = Bucket.Healths[i];
+			if (Bucket.States[i] == EEnemyMovementStatus::EMS_MoveToTarget)
+			{
+				Enemy->MoveToTarget(Player);
+			}
+
+			PromotedEnemies.Add(Enemy);
+			RemoveAgent(b, i);
+			++NumPromotionsLastFrame;
+		}
+	}
+}
+
+void AHordeManager::DemoteEnemies(const AMainCharacter* Player)
+{
+	AEnemyPool* EnemyPool = AEnemyPool::Get(this);
+	const float DemoteDistanceSquared = FMath::Square(DemoteDistance);
+	const FVector PlayerLocation = Player->GetActorLocation();
+
+	for (int32 i = PromotedEnemies.Num() - 1; i >= 0; i--)
+	{
+		AEnemy* Enemy = PromotedEnemies[i];
+
+		// Enemies that died or were pooled since are no longer the horde's business
+		if (!IsValid(Enemy) || !Enemy->Alive() || Enemy->IsInPool())
+		{
+			PromotedEnemies.RemoveAtSwap(i);
+			continue;
+		}
+
+		if (NumDemotionsLastFrame >= MaxDemotionsPerFrame) { continue; }
+
+		// Only enemies out of the fight can be turned back into agents
+		const EEnemyMovementStatus Status = Enemy->GetEnemyMovementStatus();
+		if (Status != EEnemyMovementStatus::EMS_Idle && Status != EEnemyMovementStatus::EMS_MoveToTarget) { continue; }
+		if (Enemy->bOverlappingCombatSphere) { continue; }
+		if (FVector::DistSquared2D(Enemy->GetActorLocation(), PlayerLocation) <= DemoteDistanceSquared) { continue; }
+
+		AddAgent(Enemy->GetClass(), Enemy->GetActorLocation(), Enemy->Health, Status);
+
+		PromotedEnemies.RemoveAtSwap(i);
+		if (EnemyPool == nullptr || !EnemyPool->Release(Enemy))
+		{
+			Enemy->Destroy();
+		}
+		++NumDemotionsLastFrame;
+	}
+}
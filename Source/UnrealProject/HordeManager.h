@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Enemy.h"
+#include "HordeManager.generated.h"
+
+/** Lightweight enemies of one class, stored as parallel arrays */
+struct FHordeBucket
+{
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> Healths;
+	TArray<EEnemyMovementStatus> States;
+
+	/** Index of the chased player, INDEX_NONE while idle */
+	TArray<int8> Targets;
+
+	/** Written by the simulation, read back on the game thread */
+	TArray<bool> WantsPromotion;
+	TArray<FTransform> InstanceTransforms;
+
+	/** Taken from the enemy class defaults */
+	float Speed;
+	float HalfHeight;
+	float AgroRadius;
+
+	int32 Num() const { return Positions.Num(); }
+};
+
+/**
+ * Background enemies simulated as plain data on worker threads and drawn as instanced meshes.
+ * Agents close to the player are promoted to real AEnemy actors from the enemy pool,
+ * and promoted enemies that fall far behind are turned back into agents.
+ * Health and movement status are carried across both ways.
+ * Agents chase the player only within their class's AgroSphere radius, like the enemy they stand for.
+ * They never attack, take damage or die, an agent is always idle or moving to the player.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API AHordeManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AHordeManager();
+
+	static AHordeManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** Agents within this distance are turned into real enemies */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Horde")
+	float PromoteDistance;
+
+	/** Promoted enemies further than this go back to being agents, keep it above PromoteDistance */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Horde")
+	float DemoteDistance;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Horde")
+	int32 MaxPromotionsPerFrame;
+
+	/** How far from an agent a promoted enemy is looked for on the navmesh, agents walk straight and drift off it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Horde")
+	FVector PromotionProjectionExtent;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Horde")
+	int32 MaxDemotionsPerFrame;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Horde | Stats")
+	int32 NumAgents;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Horde | Stats")
+	int32 NumPromotedEnemies;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Horde | Stats")
+	int32 NumPromotionsLastFrame;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Horde | Stats")
+	int32 NumDemotionsLastFrame;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Horde | Stats")
+	float SimulationTimeMs;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	/** Add a background enemy of Class, with its class default health unless Health is given */
+	void AddAgent(TSubclassOf<AEnemy> Class, const FVector& Location, float Health = -1.f, EEnemyMovementStatus Status = EEnemyMovementStatus::EMS_Idle);
+
+private:
+	int32 FindOrAddBucket(UClass* Class);
+
+	void RemoveAgent(int32 BucketIndex, int32 AgentIndex);
+
+	void Simulate(float DeltaTime, const class AMainCharacter* Player);
+
+	void PromoteAgents(AMainCharacter* Player);
+
+	void DemoteEnemies(const AMainCharacter* Player);
+
+	/** Buckets and the class and instanced mesh of each, kept in matching order */
+	TArray<FHordeBucket> Buckets;
+
+	UPROPERTY()
+	TArray<UClass*> BucketClasses;
+
+	UPROPERTY()
+	TArray<class UInstancedStaticMeshComponent*> BucketMeshes;
+
+	/** Enemies that came out of the horde and may be sent back to it */
+	UPROPERTY()
+	TArray<AEnemy*> PromotedEnemies;
+};
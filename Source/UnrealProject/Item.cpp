@@ -2,9 +2,13 @@
 
 
 #include "Item.h"
+#include "AssetStreamingSubsystem.h"
+#include "BatchTickManager.h"
 #include "Components/SphereComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "TimerManager.h"
 
 // Sets default values
 AItem::AItem()
@@ -23,6 +27,10 @@ AItem::AItem()
 
 	bRotate = false;
 	RotationRate = 60.f;
+
+	PreloadRadius = 3000.f;
+
+	BatchTickId = INDEX_NONE;
 }
 
 // Called when the game starts or when spawned
@@ -32,6 +40,38 @@ void AItem::BeginPlay()
 
 	CollisionVolume->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnOverlapBegin);
 	CollisionVolume->OnComponentEndOverlap.AddDynamic(this, &AItem::OnOverlapEnd);
+
+	// Rotating is all the native tick does, the batch tick manager does it for every rotating item at once.
+	// Items that don't rotate aren't registered, SetRotate registers them once they start
+	ABatchTickManager* BatchTickManager = ABatchTickManager::Get(this);
+	if (BatchTickManager && ABatchTickManager::CanBatchTick(this))
+	{
+		if (bRotate)
+		{
+			BatchTickManager->RegisterItem(this);
+		}
+		SetActorTickEnabled(false);
+	}
+
+	TArray<FSoftObjectPath> Assets;
+	GetPreloadAssets(Assets);
+	Assets.RemoveAll([](const FSoftObjectPath& Asset) { return Asset.IsNull(); });
+	if (Assets.Num() > 0)
+	{
+		// Offset so a level full of items doesn't check all of them in the same frame
+		GetWorldTimerManager().SetTimer(PreloadTimer, this, &AItem::CheckPreloadDistance, 0.5f, true, FMath::FRandRange(0.f, 0.5f));
+	}
+}
+
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ABatchTickManager* BatchTickManager = ABatchTickManager::Get(this, false);
+	if (BatchTickManager)
+	{
+		BatchTickManager->UnregisterItem(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -47,6 +87,48 @@ void AItem::Tick(float DeltaTime)
 	}
 }
 
+void AItem::SetRotate(bool bNewRotate)
+{
+	bRotate = bNewRotate;
+
+	// Before BeginPlay the item registers itself, items with a Blueprint tick keep rotating themselves
+	if (!HasActorBegunPlay() || !ABatchTickManager::CanBatchTick(this)) { return; }
+
+	ABatchTickManager* BatchTickManager = ABatchTickManager::Get(this, bRotate);
+	if (BatchTickManager == nullptr) { return; }
+
+	if (bRotate)
+	{
+		BatchTickManager->RegisterItem(this);
+	}
+	else
+	{
+		BatchTickManager->UnregisterItem(this);
+	}
+}
+
+void AItem::GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	OutAssets.Add(OverlapParticles.ToSoftObjectPath());
+	OutAssets.Add(OverlapSound.ToSoftObjectPath());
+}
+
+void AItem::CheckPreloadDistance()
+{
+	APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (Player == nullptr || FVector::DistSquared(Player->GetActorLocation(), GetActorLocation()) > FMath::Square(PreloadRadius)) { return; }
+
+	GetWorldTimerManager().ClearTimer(PreloadTimer);
+
+	UAssetStreamingSubsystem* AssetStreamingSubsystem = UAssetStreamingSubsystem::Get(this);
+	if (AssetStreamingSubsystem)
+	{
+		TArray<FSoftObjectPath> Assets;
+		GetPreloadAssets(Assets);
+		AssetStreamingSubsystem->Preload(Assets);
+	}
+}
+
 void AItem::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
 }
@@ -29,32 +29,53 @@ public:
 
 	/** Particles emitted when overlapped */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Particles")
-	class UParticleSystem* OverlapParticles;
+	TSoftObjectPtr<class UParticleSystem> OverlapParticles;
 
 	/** Sound emitted when overlapped */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Sounds")
-	class USoundCue* OverlapSound;
+	TSoftObjectPtr<class USoundCue> OverlapSound;
 
-	/** Does item rotate */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | ItemProperties")
+	/** Does item rotate, set it through SetRotate once the game has started */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetRotate, Category = "Item | ItemProperties")
 	bool bRotate;
 
 	/** Rate of rotation */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | ItemProperties")
 	float RotationRate;
 
+	/** The item's assets start loading once the player is this close */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Streaming")
+	float PreloadRadius;
+
+	/** Slot in the batch tick manager, INDEX_NONE while the item doesn't rotate or rotates itself */
+	int32 BatchTickId;
+
+	/** Soft referenced assets used when the item is picked up or used */
+	virtual void GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	/** Start or stop rotating, only rotating items are updated by the batch tick manager */
+	UFUNCTION(BlueprintSetter)
+	void SetRotate(bool bNewRotate);
+
 	UFUNCTION()
 	virtual void OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
 	UFUNCTION()
 	virtual void OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
+private:
+	/** Preload the item's assets once the player is within PreloadRadius */
+	void CheckPreloadDistance();
+
+	FTimerHandle PreloadTimer;
 };
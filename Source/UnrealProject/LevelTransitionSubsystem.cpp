@@ -0,0 +1,243 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LevelTransitionSubsystem.h"
+#include "UnrealProject.h"
+#include "ChunkSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "UObject/UObjectGlobals.h"
+
+ULevelTransitionSubsystem::ULevelTransitionSubsystem()
+{
+	MaxResidentLevels = 2;
+
+	LastPreloadTimeMs = 0.f;
+	LastTransitionTimeMs = 0.f;
+	NumPreloadHits = 0;
+	NumPreloadMisses = 0;
+	NumResidentLevels = 0;
+
+	TransitionStartTime = 0.0;
+	bTransitionPreloaded = false;
+}
+
+ULevelTransitionSubsystem* ULevelTransitionSubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<ULevelTransitionSubsystem>() : nullptr;
+}
+
+void ULevelTransitionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ULevelTransitionSubsystem::OnPostLoadMap);
+}
+
+void ULevelTransitionSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+	for (FResidentLevel& Level : ResidentLevels)
+	{
+		if (Level.Handle.IsValid())
+		{
+			Level.Handle->ReleaseHandle();
+		}
+	}
+	ResidentLevels.Empty();
+
+	Super::Deinitialize();
+}
+
+void ULevelTransitionSubsystem::PreloadLevel(FName LevelName)
+{
+	if (FPackageName::GetShortFName(LevelName) == GetCurrentLevelName()) { return; }
+
+	// A level whose chunk isn't mounted yet has nothing to preload until it is
+	UChunkSubsystem* ChunkSubsystem = GetGameInstance()->GetSubsystem<UChunkSubsystem>();
+	const FName MapPackage = FindMapPackage(LevelName);
+	if (ChunkSubsystem && !ChunkSubsystem->AreMapChunksMounted(MapPackage))
+	{
+		ChunkSubsystem->MountMapChunks(MapPackage, FOnChunksMounted::CreateUObject(this, &ULevelTransitionSubsystem::OnLevelChunksMounted, LevelName));
+		return;
+	}
+
+	RequestLevelAssets(LevelName);
+}
+
+void ULevelTransitionSubsystem::OnLevelChunksMounted(bool bSuccess, FName LevelName)
+{
+	if (bSuccess)
+	{
+		RequestLevelAssets(LevelName);
+	}
+}
+
+bool ULevelTransitionSubsystem::OpenLevel(FName LevelName)
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (World == nullptr) { return false; }
+
+	// Normally mounted by the preload already, a level opened without one waits here for its chunk.
+	// Travelling to a map that isn't there would drop the player back to the default map
+	UChunkSubsystem* ChunkSubsystem = GetGameInstance()->GetSubsystem<UChunkSubsystem>();
+	if (ChunkSubsystem && !ChunkSubsystem->MountMapChunksNow(FindMapPackage(LevelName)))
+	{
+		UE_LOG(LogUnrealProject, Warning, TEXT("Can't open %s, its chunks failed to mount"), *LevelName.ToString());
+		OnLevelOpenFailed.Broadcast(LevelName);
+		return false;
+	}
+
+	const FName ShortName = FPackageName::GetShortFName(LevelName);
+	const FResidentLevel* Preloaded = ResidentLevels.FindByPredicate([ShortName](const FResidentLevel& Level) { return Level.LevelName == ShortName; });
+	bTransitionPreloaded = Preloaded && (!Preloaded->Handle.IsValid() || Preloaded->Handle->HasLoadCompleted());
+	if (bTransitionPreloaded)
+	{
+		++NumPreloadHits;
+	}
+	else
+	{
+		++NumPreloadMisses;
+	}
+
+	// Everything the current level uses is loaded already, holding it costs nothing now and saves loading it on the way back
+	RequestLevelAssets(GetCurrentLevelName());
+	RequestLevelAssets(LevelName);
+
+	TransitionStartTime = FPlatformTime::Seconds();
+	TransitionLevelName = ShortName;
+	UGameplayStatics::OpenLevel(World, LevelName);
+	return true;
+}
+
+FName ULevelTransitionSubsystem::GetCurrentLevelName()
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (World && World != CurrentWorld.Get())
+	{
+		FString MapName = World->GetMapName();
+		MapName.RemoveFromStart(World->StreamingLevelsPrefix);
+		CurrentLevelName = FName(*MapName);
+		CurrentWorld = World;
+	}
+	return CurrentLevelName;
+}
+
+void ULevelTransitionSubsystem::OnPreloadFinished(FName LevelName)
+{
+	const FResidentLevel* Level = ResidentLevels.FindByPredicate([LevelName](const FResidentLevel& Resident) { return Resident.LevelName == LevelName; });
+	if (Level == nullptr) { return; }
+
+	LastPreloadTimeMs = (float)((FPlatformTime::Seconds() - Level->RequestTime) * 1000.0);
+}
+
+void ULevelTransitionSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (TransitionStartTime <= 0.0) { return; }
+
+	LastTransitionTimeMs = (float)((FPlatformTime::Seconds() - TransitionStartTime) * 1000.0);
+	TransitionStartTime = 0.0;
+
+	UE_LOG(LogUnrealProject, Verbose, TEXT("Level transition to %s took %.1f ms, assets %s"), *TransitionLevelName.ToString(), LastTransitionTimeMs, bTransitionPreloaded ? TEXT("preloaded") : TEXT("loaded with the map"));
+}
+
+FResidentLevel* ULevelTransitionSubsystem::RequestLevelAssets(FName LevelName)
+{
+	const FName ShortName = FPackageName::GetShortFName(LevelName);
+	if (ShortName.IsNone()) { return nullptr; }
+
+	const int32 Index = ResidentLevels.IndexOfByPredicate([ShortName](const FResidentLevel& Level) { return Level.LevelName == ShortName; });
+	if (Index != INDEX_NONE)
+	{
+		if (Index > 0)
+		{
+			FResidentLevel Level = MoveTemp(ResidentLevels[Index]);
+			ResidentLevels.RemoveAt(Index);
+			ResidentLevels.Insert(MoveTemp(Level), 0);
+		}
+		return &ResidentLevels[0];
+	}
+
+	const FName MapPackage = FindMapPackage(LevelName);
+	if (MapPackage.IsNone()) { return nullptr; }
+
+	FResidentLevel Level;
+	Level.LevelName = ShortName;
+	Level.RequestTime = FPlatformTime::Seconds();
+
+	const TArray<FSoftObjectPath> Assets = GetMapDependencies(MapPackage);
+	if (Assets.Num() > 0)
+	{
+		Level.Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Assets, FStreamableDelegate::CreateUObject(this, &ULevelTransitionSubsystem::OnPreloadFinished, ShortName));
+	}
+	ResidentLevels.Insert(MoveTemp(Level), 0);
+
+	// Released handles let their assets go with the garbage collection of the next level change
+	while (ResidentLevels.Num() > FMath::Max(MaxResidentLevels, 2))
+	{
+		if (ResidentLevels.Last().Handle.IsValid())
+		{
+			ResidentLevels.Last().Handle->ReleaseHandle();
+		}
+		ResidentLevels.Pop();
+	}
+	NumResidentLevels = ResidentLevels.Num();
+
+	return &ResidentLevels[0];
+}
+
+FName ULevelTransitionSubsystem::FindMapPackage(FName LevelName)
+{
+	const FString LevelString = LevelName.ToString();
+	if (FPackageName::IsValidLongPackageName(LevelString)) { return LevelName; }
+
+	if (MapPackages.Num() == 0)
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+		TArray<FAssetData> Maps;
+		AssetRegistry.GetAssetsByClass(UWorld::StaticClass()->GetFName(), Maps);
+		for (const FAssetData& Map : Maps)
+		{
+			MapPackages.Add(Map.AssetName, Map.PackageName);
+		}
+	}
+
+	const FName* MapPackage = MapPackages.Find(LevelName);
+	return MapPackage ? *MapPackage : NAME_None;
+}
+
+TArray<FSoftObjectPath> ULevelTransitionSubsystem::GetMapDependencies(FName MapPackage) const
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	TArray<FName> Dependencies;
+	AssetRegistry.GetDependencies(MapPackage, Dependencies, EAssetRegistryDependencyType::Hard);
+
+	// Built lighting belongs to its map and is loaded with it, holding it would only keep lightmaps of maps already left
+	const FString BuiltDataPackage = MapPackage.ToString() + TEXT("_BuiltData");
+
+	TArray<FSoftObjectPath> Assets;
+	for (const FName& Dependency : Dependencies)
+	{
+		const FString DependencyString = Dependency.ToString();
+		if (DependencyString.StartsWith(TEXT("/Script/")) || DependencyString == BuiltDataPackage) { continue; }
+
+		TArray<FAssetData> PackageAssets;
+		AssetRegistry.GetAssetsByPackageName(Dependency, PackageAssets);
+		for (const FAssetData& Asset : PackageAssets)
+		{
+			if (Asset.AssetClass == UWorld::StaticClass()->GetFName()) { continue; }
+
+			Assets.Add(Asset.ToSoftObjectPath());
+		}
+	}
+	return Assets;
+}
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "LevelTransitionSubsystem.generated.h"
+
+struct FStreamableHandle;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnLevelOpenFailed, FName, LevelName);
+
+/** Assets of one level held in memory, newest first in ResidentLevels */
+struct FResidentLevel
+{
+	FName LevelName;
+
+	/** Keeps the level's assets loaded for as long as it is held */
+	TSharedPtr<FStreamableHandle> Handle;
+
+	/** When the preload was requested */
+	double RequestTime;
+};
+
+/**
+ * Opens levels with their assets already in memory.
+ * Approaching a transition volume starts loading everything the destination map references in the background,
+ * so OpenLevel only has to load the map itself. The assets of the last few levels stay loaded as well,
+ * going back and forth between two maps never reloads what they share.
+ */
+UCLASS()
+class UNREALPROJECT_API ULevelTransitionSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	ULevelTransitionSubsystem();
+
+	static ULevelTransitionSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Broadcast when OpenLevel gives up because the level's chunks couldn't be mounted */
+	UPROPERTY(BlueprintAssignable, Category = "Level Transition")
+	FOnLevelOpenFailed OnLevelOpenFailed;
+
+	/** Levels whose assets are kept loaded, the current one and preloaded ones included */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Transition")
+	int32 MaxResidentLevels;
+
+	/** Time from requesting a preload until all of its assets were in memory */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Level Transition | Stats")
+	float LastPreloadTimeMs;
+
+	/** Time from OpenLevel until the new map was loaded */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Level Transition | Stats")
+	float LastTransitionTimeMs;
+
+	/** Transitions that found the destination's assets fully loaded */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Level Transition | Stats")
+	int32 NumPreloadHits;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Level Transition | Stats")
+	int32 NumPreloadMisses;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Level Transition | Stats")
+	int32 NumResidentLevels;
+
+	/** Start loading the assets LevelName references, does nothing if they already are */
+	void PreloadLevel(FName LevelName);
+
+	/** Travel to LevelName, keeping the current level's assets loaded for the way back. False if it can't be opened, the current level stays */
+	bool OpenLevel(FName LevelName);
+
+	/** Short name of the map being played, worked out once per map */
+	FName GetCurrentLevelName();
+
+	/** Long package name of the map called LevelName, none if there is no such map */
+	FName FindMapPackage(FName LevelName);
+
+private:
+	void OnPreloadFinished(FName LevelName);
+
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	/** Move LevelName to the front of ResidentLevels, requesting its assets if it isn't there yet */
+	FResidentLevel* RequestLevelAssets(FName LevelName);
+
+	void OnLevelChunksMounted(bool bSuccess, FName LevelName);
+
+	/** Assets the map package references, everything its actors need. Cooked builds only know them with bSerializeDependencies set under [AssetRegistry] */
+	TArray<FSoftObjectPath> GetMapDependencies(FName MapPackage) const;
+
+	TArray<FResidentLevel> ResidentLevels;
+
+	/** Short map names to long package names, filled from the asset registry the first time */
+	TMap<FName, FName> MapPackages;
+
+	TWeakObjectPtr<UWorld> CurrentWorld;
+	FName CurrentLevelName;
+
+	/** Set while OpenLevel is waiting for the new map */
+	double TransitionStartTime;
+	FName TransitionLevelName;
+	bool bTransitionPreloaded;
+
+	FDelegateHandle PostLoadMapHandle;
+};
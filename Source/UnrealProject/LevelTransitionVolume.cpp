@@ -3,7 +3,9 @@
 
 #include "LevelTransitionVolume.h"
 #include "MainCharacter.h"
+#include "LevelTransitionSubsystem.h"
 #include "Components/BoxComponent.h"
+#include "Components/SphereComponent.h"
 #include "Components/BillboardComponent.h"
 
 // Sets default values
@@ -18,6 +20,10 @@ ALevelTransitionVolume::ALevelTransitionVolume()
 	Billboard = CreateDefaultSubobject<UBillboardComponent>(TEXT("Billboard"));
 	Billboard->SetupAttachment(GetRootComponent());
 
+	PrefetchSphere = CreateDefaultSubobject<USphereComponent>(TEXT("PrefetchSphere"));
+	PrefetchSphere->SetupAttachment(GetRootComponent());
+	PrefetchSphere->InitSphereRadius(2500.f);
+
 	TransitionLevelName = "SunTemple";
 }
 
@@ -27,6 +33,7 @@ void ALevelTransitionVolume::BeginPlay()
 	Super::BeginPlay();
 	
 	TransitionVolume->OnComponentBeginOverlap.AddDynamic(this, &ALevelTransitionVolume::OnOverlapBegin);
+	PrefetchSphere->OnComponentBeginOverlap.AddDynamic(this, &ALevelTransitionVolume::PrefetchOnOverlapBegin);
 }
 
 // Called every frame
@@ -46,4 +53,15 @@ void ALevelTransitionVolume::OnOverlapBegin(UPrimitiveComponent* OverlappedCompo
 			MainCharacter->SwitchLevel(TransitionLevelName);
 		}
 	}
+}
+
+void ALevelTransitionVolume::PrefetchOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	if (Cast<AMainCharacter>(OtherActor) == nullptr) { return; }
+
+	ULevelTransitionSubsystem* LevelTransitionSubsystem = ULevelTransitionSubsystem::Get(this);
+	if (LevelTransitionSubsystem)
+	{
+		LevelTransitionSubsystem->PreloadLevel(TransitionLevelName);
+	}
 }
\ No newline at end of file
@@ -21,6 +21,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition")
 	FName TransitionLevelName;
 
+	/** The player entering this sphere starts loading the destination level's assets in the background */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Transition")
+	class USphereComponent* PrefetchSphere;
+
 	class UBillboardComponent* Billboard;
 
 protected:
@@ -34,4 +38,7 @@ public:
 	UFUNCTION()
 	virtual void OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
+	UFUNCTION()
+	void PrefetchOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
 };
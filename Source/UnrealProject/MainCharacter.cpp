@@ -5,8 +5,16 @@
 #include "Weapon.h"
 #include "Enemy.h"
 #include "FirstSaveGame.h"
-#include "ItemStorage.h"
+#include "SaveGameSubsystem.h"
+#include "WorldStateManager.h"
+#include "CheckpointSubsystem.h"
+#include "PersistentPlayerSubsystem.h"
+#include "LevelTransitionSubsystem.h"
+#include "AssetStreamingSubsystem.h"
+#include "WeaponRegistry.h"
 #include "MainPlayerController.h"
+#include "CombatRangeManager.h"
+#include "TileStreamingManager.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/InputComponent.h"
 #include "Components/CapsuleComponent.h"
@@ -19,7 +27,10 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/GameplayStatics.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
 #include "Sound/SoundCue.h"
+#include "TimerManager.h"
+#include "Misc/PackageName.h"
 
 // Sets default values
 AMainCharacter::AMainCharacter()
@@ -58,6 +69,13 @@ AMainCharacter::AMainCharacter()
 	GetCharacterMovement()->AirControl = 0.2f;
 
 	bHasCombatTarget = false;
+	bCombatTargetLocked = false;
+
+	bRestoredFromTransition = false;
+	PendingWeaponName = NAME_None;
+
+	TargetFacingWeight = 0.5f;
+	TargetHealthWeight = 0.25f;
 
 	MaxHealth = 100.f;
 	Health = 100.f;
@@ -66,6 +84,7 @@ AMainCharacter::AMainCharacter()
 	Stamina = 150.f;
 
 	Coins = 0.f;
+	PlayTime = 0.f;
 
 	WalkingSpeed = 250.f;
 	RunningSpeed = 650.f;
@@ -105,11 +124,58 @@ void AMainCharacter::BeginPlay()
 	FString MapName = GetWorld()->GetMapName();
 	MapName.RemoveFromStart(GetWorld()->StreamingLevelsPrefix);
 
+	// Coming from another level the live state is waiting in memory, no save slot involved
+	UPersistentPlayerSubsystem* PersistentPlayerSubsystem = UPersistentPlayerSubsystem::Get(this);
+	if (PersistentPlayerSubsystem)
+	{
+		bRestoredFromTransition = PersistentPlayerSubsystem->RestoreCharacter(this);
+	}
+
 	//LoadGameNoSwitch();
 	if (MainPlayerController)
 	{
 		MainPlayerController->GameModeOnly();
 	}
+
+	ACombatRangeManager* CombatRangeManager = ACombatRangeManager::Get(this);
+	if (CombatRangeManager)
+	{
+		CombatRangeManager->RegisterPlayer(this);
+	}
+
+	// Started with the level so it sees every placed actor before any is picked up or killed
+	AWorldStateManager::Get(this);
+
+	// A save loaded in the previous level describes this one too
+	if (!PendingWorldStatePlayerName.IsEmpty())
+	{
+		LoadWorldState(PendingWorldStatePlayerName);
+		PendingWorldStatePlayerName.Empty();
+	}
+
+	// Streams tiled maps around the player, switches itself off in maps without tiles
+	ATileStreamingManager::Get(this);
+
+	// Attacking or equipping right after spawning shouldn't have to wait for the montages
+	UAssetStreamingSubsystem* AssetStreamingSubsystem = UAssetStreamingSubsystem::Get(this);
+	if (AssetStreamingSubsystem)
+	{
+		AssetStreamingSubsystem->Preload({ CombatMontage.ToSoftObjectPath(), UpperBodyMontage.ToSoftObjectPath() });
+	}
+
+	// Entering a level is a checkpoint, taken once the level's saved state has been applied
+	GetWorldTimerManager().SetTimerForNextTick(this, &AMainCharacter::CaptureCheckpoint);
+}
+
+void AMainCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ACombatRangeManager* CombatRangeManager = ACombatRangeManager::Get(this, false);
+	if (CombatRangeManager)
+	{
+		CombatRangeManager->UnregisterPlayer(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -117,6 +183,8 @@ void AMainCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	PlayTime += DeltaTime;
+
 	if (MovementStatus == EMovementStatus::EMS_Dead) { return; }
 
 	float DeltaStamnia = StaminaDrainRate * DeltaTime;
@@ -240,6 +308,8 @@ void AMainCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompo
 
 	PlayerInputComponent->BindAction(TEXT("Block"), IE_Pressed, this, &AMainCharacter::BlockDown);
 	PlayerInputComponent->BindAction(TEXT("Block"), IE_Released, this, &AMainCharacter::BlockUp);
+
+	PlayerInputComponent->BindAction(TEXT("CycleTarget"), IE_Pressed, this, &AMainCharacter::CycleCombatTarget);
 	
 	PlayerInputComponent->BindAxis(TEXT("MoveForward"), this, &AMainCharacter::MoveForward);
 	PlayerInputComponent->BindAxis(TEXT("MoveRight"), this, &AMainCharacter::MoveRight);
@@ -355,12 +425,13 @@ void AMainCharacter::FootStep(bool IsLeft)
 void AMainCharacter::PlayAttackAnimation()
 {
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if (AnimInstance && CombatMontage)
+	UAnimMontage* Montage = UAssetStreamingSubsystem::Resolve(this, CombatMontage);
+	if (AnimInstance && Montage)
 	{
 		int32 CurrentSection = (Section % NumOfSections) + 1;
 		FString SectionName(FString::Printf(TEXT("Attack_%d"), CurrentSection));
-		AnimInstance->Montage_Play(CombatMontage, 2.f);
-		AnimInstance->Montage_JumpToSection(FName(*SectionName), CombatMontage);
+		AnimInstance->Montage_Play(Montage, 2.f);
+		AnimInstance->Montage_JumpToSection(FName(*SectionName), Montage);
 	}
 }
 
@@ -451,10 +522,11 @@ void AMainCharacter::Die()
 	if (MovementStatus == EMovementStatus::EMS_Dead) { return; }
 
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if (AnimInstance && CombatMontage)
+	UAnimMontage* Montage = UAssetStreamingSubsystem::Resolve(this, CombatMontage);
+	if (AnimInstance && Montage)
 	{
-		AnimInstance->Montage_Play(CombatMontage, 1.f);
-		AnimInstance->Montage_JumpToSection(FName("Death"), CombatMontage);
+		AnimInstance->Montage_Play(Montage, 1.f);
+		AnimInstance->Montage_JumpToSection(FName("Death"), Montage);
 	}
 	SetMovementStatus(EMovementStatus::EMS_Dead);
 }
@@ -511,10 +583,11 @@ void AMainCharacter::AttackDown()
 		if (UnequippedWeapon)
 		{
 			UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-			if (AnimInstance && UpperBodyMontage)
+			UAnimMontage* Montage = UAssetStreamingSubsystem::Resolve(this, UpperBodyMontage);
+			if (AnimInstance && Montage)
 			{
-				AnimInstance->Montage_Play(UpperBodyMontage, 1.f);
-				AnimInstance->Montage_JumpToSection(FName("Equip"), UpperBodyMontage);
+				AnimInstance->Montage_Play(Montage, 1.f);
+				AnimInstance->Montage_JumpToSection(FName("Equip"), Montage);
 			}
 		}
 	}
@@ -531,10 +604,11 @@ void AMainCharacter::BlockDown()
 	{
 		bBlockDown = true;
 		UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-		if (AnimInstance && UpperBodyMontage)
+		UAnimMontage* Montage = UAssetStreamingSubsystem::Resolve(this, UpperBodyMontage);
+		if (AnimInstance && Montage)
 		{
-			AnimInstance->Montage_Play(UpperBodyMontage, 1.f);
-			AnimInstance->Montage_JumpToSection(FName("Block"), UpperBodyMontage);
+			AnimInstance->Montage_Play(Montage, 1.f);
+			AnimInstance->Montage_JumpToSection(FName("Block"), Montage);
 		}
 	}	
 }
@@ -542,10 +616,11 @@ void AMainCharacter::BlockDown()
 void AMainCharacter::BlockUp()
 {
 	bBlockDown = false;
+	// Nothing to stop if the montage was never loaded
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	if (AnimInstance && UpperBodyMontage)
+	if (AnimInstance && UpperBodyMontage.IsValid())
 	{
-		AnimInstance->Montage_Stop(0.25f, UpperBodyMontage);
+		AnimInstance->Montage_Stop(0.25f, UpperBodyMontage.Get());
 	}
 }
 
@@ -591,19 +666,21 @@ void AMainCharacter::PlayEquipMontage()
 	if (EquippedWeapon)
 	{
 		UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-		if (AnimInstance && UpperBodyMontage)
+		UAnimMontage* Montage = UAssetStreamingSubsystem::Resolve(this, UpperBodyMontage);
+		if (AnimInstance && Montage)
 		{
-			AnimInstance->Montage_Play(UpperBodyMontage, 1.f);
-			AnimInstance->Montage_JumpToSection(FName("Unequip"), UpperBodyMontage);
+			AnimInstance->Montage_Play(Montage, 1.f);
+			AnimInstance->Montage_JumpToSection(FName("Unequip"), Montage);
 		}
 	}
 	else if (UnequippedWeapon)
 	{
 		UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-		if (AnimInstance && UpperBodyMontage)
+		UAnimMontage* Montage = UAssetStreamingSubsystem::Resolve(this, UpperBodyMontage);
+		if (AnimInstance && Montage)
 		{
-			AnimInstance->Montage_Play(UpperBodyMontage, 1.f);
-			AnimInstance->Montage_JumpToSection(FName("Equip"), UpperBodyMontage);
+			AnimInstance->Montage_Play(Montage, 1.f);
+			AnimInstance->Montage_JumpToSection(FName("Equip"), Montage);
 		}
 	}
 }
@@ -653,49 +730,129 @@ void AMainCharacter::SetEquippedWeapon(AWeapon* WeaponToSet)
 
 void AMainCharacter::PlaySwingSound()
 {
-	if (EquippedWeapon->SwingSound)
+	USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, EquippedWeapon->SwingSound);
+	if (Sound)
 	{
-		UGameplayStatics::PlaySound2D(this, EquippedWeapon->SwingSound);
+		UGameplayStatics::PlaySound2D(this, Sound);
 	}
 }
 
 void AMainCharacter::UpdateCombatTarget()
 {
-	TArray<AActor*> OverlappingActors;
-	GetOverlappingActors(OverlappingActors, EnemyFilter);
+	// Candidates that died since entering range drop out here, their range end event comes a frame later
+	TargetCandidates.RemoveAllSwap([](AEnemy* Enemy) { return !IsValid(Enemy) || !Enemy->Alive(); });
+
+	AEnemy* BestEnemy = nullptr;
+	if (bCombatTargetLocked && TargetCandidates.Contains(CombatTarget))
+	{
+		BestEnemy = CombatTarget;
+	}
+	else
+	{
+		bCombatTargetLocked = false;
 
-	if (OverlappingActors.Num() == 0) 
-	{ 
+		float BestScore = MAX_FLT;
+		for (AEnemy* Enemy : TargetCandidates)
+		{
+			if (EnemyFilter && !Enemy->IsA(EnemyFilter)) { continue; }
+
+			const float Score = ScoreTarget(Enemy);
+			if (Score < BestScore)
+			{
+				BestScore = Score;
+				BestEnemy = Enemy;
+			}
+		}
+	}
+
+	if (BestEnemy == nullptr)
+	{
 		if (MainPlayerController)
 		{
 			MainPlayerController->RemoveEnemyHealthBar();
 		}
 		return;
 	}
-	
-	AEnemy* ClosestEnemy = Cast<AEnemy>(OverlappingActors[0]);
-	if (ClosestEnemy)
+
+	if (MainPlayerController)
+	{
+		MainPlayerController->DisplayEnemyHealthBar();
+		MainPlayerController->EnemyLocation = BestEnemy->GetActorLocation();
+	}
+	SetCombatTarget(BestEnemy);
+	bHasCombatTarget = true;
+}
+
+void AMainCharacter::AddTargetCandidate(AEnemy* Enemy)
+{
+	if (Enemy)
+	{
+		TargetCandidates.AddUnique(Enemy);
+	}
+}
+
+void AMainCharacter::RemoveTargetCandidate(AEnemy* Enemy)
+{
+	TargetCandidates.RemoveSwap(Enemy);
+}
+
+float AMainCharacter::ScoreTarget(const AEnemy* Enemy) const
+{
+	const FVector Delta = Enemy->GetActorLocation() - GetActorLocation();
+	const float DistanceSquared = Delta.SizeSquared();
+
+	// 0 for an enemy straight ahead up to 2 for one straight behind
+	const float Facing = DistanceSquared > KINDA_SMALL_NUMBER ? 1.f - FVector::DotProduct(GetActorForwardVector(), Delta) * FMath::InvSqrt(DistanceSquared) : 0.f;
+	const float HealthFraction = Enemy->MaxHealth > 0.f ? FMath::Clamp(Enemy->Health / Enemy->MaxHealth, 0.f, 1.f) : 1.f;
+
+	// Weights scale the squared distance, so no square root is needed to compare candidates
+	return DistanceSquared * (1.f + TargetFacingWeight * Facing) * (1.f + TargetHealthWeight * HealthFraction);
+}
+
+void AMainCharacter::CycleCombatTarget()
+{
+	const bool bHasCurrent = CombatTarget && TargetCandidates.Contains(CombatTarget);
+	const float CurrentScore = bHasCurrent ? ScoreTarget(CombatTarget) : -1.f;
+
+	// Candidates are ordered by score, ties by address, so every one of them is visited before wrapping around
+	auto IsBefore = [](float ScoreA, const AEnemy* A, float ScoreB, const AEnemy* B)
+	{
+		return ScoreA < ScoreB || (ScoreA == ScoreB && (UPTRINT)A < (UPTRINT)B);
+	};
+
+	// The next worse scored candidate, wrapping around to the best one
+	AEnemy* NextEnemy = nullptr;
+	AEnemy* BestEnemy = nullptr;
+	float NextScore = MAX_FLT;
+	float BestScore = MAX_FLT;
+	for (AEnemy* Enemy : TargetCandidates)
 	{
-		FVector Location = GetActorLocation();
-		float MinDistance = (ClosestEnemy->GetActorLocation() - Location).Size();
-		for (auto Actor : OverlappingActors)
+		if (Enemy == CombatTarget || !IsValid(Enemy) || !Enemy->Alive()) { continue; }
+		if (EnemyFilter && !Enemy->IsA(EnemyFilter)) { continue; }
+
+		const float Score = ScoreTarget(Enemy);
+		if (BestEnemy == nullptr || IsBefore(Score, Enemy, BestScore, BestEnemy))
 		{
-			AEnemy* Enemy = Cast<AEnemy>(Actor);
-			float DistanceToActor = (Enemy->GetActorLocation() - Location).Size();
-			if (DistanceToActor < MinDistance)
-			{
-				MinDistance = DistanceToActor;
-				ClosestEnemy = Enemy;
-			}
+			BestScore = Score;
+			BestEnemy = Enemy;
 		}
-
-		if (MainPlayerController)
+		if ((!bHasCurrent || IsBefore(CurrentScore, CombatTarget, Score, Enemy)) && (NextEnemy == nullptr || IsBefore(Score, Enemy, NextScore, NextEnemy)))
 		{
-			MainPlayerController->DisplayEnemyHealthBar();
+			NextScore = Score;
+			NextEnemy = Enemy;
 		}
-		SetCombatTarget(ClosestEnemy);
-		bHasCombatTarget = true;
 	}
+
+	if (NextEnemy == nullptr)
+	{
+		NextEnemy = BestEnemy;
+	}
+	if (NextEnemy == nullptr) { return; }
+
+	// Locked, so UpdateCombatTarget keeps it and only refreshes the health bar
+	SetCombatTarget(NextEnemy);
+	bCombatTargetLocked = true;
+	UpdateCombatTarget();
 }
 
 void AMainCharacter::SwitchLevel(FName LevelName)
@@ -703,11 +860,32 @@ void AMainCharacter::SwitchLevel(FName LevelName)
 	UWorld* World = GetWorld();
 	if (World)
 	{
-		FString CurrentLevel = World->GetMapName();
+		// The subsystem works the current level's name out once per map instead of on every call
+		ULevelTransitionSubsystem* LevelTransitionSubsystem = ULevelTransitionSubsystem::Get(this);
+		const FName CurrentLevel = LevelTransitionSubsystem ? LevelTransitionSubsystem->GetCurrentLevelName() : FName(*World->GetMapName());
 
-		if (FName(*CurrentLevel) != LevelName)
+		if (CurrentLevel != FPackageName::GetShortFName(LevelName))
 		{
-			UGameplayStatics::OpenLevel(World, LevelName);
+			if (LevelTransitionSubsystem)
+			{
+				// The player stays in this level, nothing is handed over
+				if (!LevelTransitionSubsystem->OpenLevel(LevelName))
+				{
+					PendingWorldStatePlayerName.Empty();
+					return;
+				}
+			}
+			else
+			{
+				UGameplayStatics::OpenLevel(World, LevelName);
+			}
+
+			// Travel happens on the next engine tick, the character is still here to be stored
+			UPersistentPlayerSubsystem* PersistentPlayerSubsystem = UPersistentPlayerSubsystem::Get(this);
+			if (PersistentPlayerSubsystem)
+			{
+				PersistentPlayerSubsystem->StoreCharacter(this, LevelName);
+			}
 		}
 	}
 }
@@ -721,6 +899,7 @@ void AMainCharacter::SaveGame()
 	SaveGameInstance->CharacterStats.Stamina = Stamina;
 	SaveGameInstance->CharacterStats.MaxStamina = MaxStamina;
 	SaveGameInstance->CharacterStats.Coins = Coins;
+	SaveGameInstance->CharacterStats.PlayTime = PlayTime;
 
 	if (EquippedWeapon)
 	{
@@ -738,33 +917,50 @@ void AMainCharacter::SaveGame()
 	SaveGameInstance->CharacterStats.Location = GetActorLocation();
 	SaveGameInstance->CharacterStats.Rotation = GetActorRotation();
 
-	UGameplayStatics::SaveGameToSlot(SaveGameInstance, SaveGameInstance->PlayerName, SaveGameInstance->UserIndex);
+	AWorldStateManager* WorldStateManager = AWorldStateManager::Get(this, false);
+	if (WorldStateManager)
+	{
+		WorldStateManager->SaveWorldState(SaveGameInstance->PlayerName);
+	}
+
+	// Written in the background, the pause menu and level exits no longer wait on the disk
+	USaveGameSubsystem* SaveGameSubsystem = USaveGameSubsystem::Get(this);
+	if (SaveGameSubsystem)
+	{
+		SaveGameSubsystem->SaveGameAsync(SaveGameInstance, SaveGameInstance->PlayerName);
+	}
+	else
+	{
+		UGameplayStatics::SaveGameToSlot(SaveGameInstance, SaveGameInstance->PlayerName, SaveGameInstance->UserIndex);
+	}
 }
 
 void AMainCharacter::LoadGame(bool SetPosition)
 {
-	UFirstSaveGame* LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::CreateSaveGameObject(UFirstSaveGame::StaticClass()));
-	LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::LoadGameFromSlot(LoadGameInstance->PlayerName, LoadGameInstance->UserIndex));
+	// The slot name and user index are class defaults, no need to create a save object to read them
+	const UFirstSaveGame* Defaults = GetDefault<UFirstSaveGame>();
+
+	// A save still being written is read back from memory
+	UFirstSaveGame* LoadGameInstance = nullptr;
+	USaveGameSubsystem* SaveGameSubsystem = USaveGameSubsystem::Get(this);
+	if (SaveGameSubsystem)
+	{
+		LoadGameInstance = Cast<UFirstSaveGame>(SaveGameSubsystem->LoadGame(Defaults->PlayerName, Defaults->UserIndex));
+	}
+	else
+	{
+		LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::LoadGameFromSlot(Defaults->PlayerName, Defaults->UserIndex));
+	}
+	if (LoadGameInstance == nullptr) { return; }
 
 	Health = LoadGameInstance->CharacterStats.Health;
 	MaxHealth = LoadGameInstance->CharacterStats.MaxHealth;
 	Stamina = LoadGameInstance->CharacterStats.Stamina;
 	MaxStamina = LoadGameInstance->CharacterStats.MaxStamina;
 	Coins = LoadGameInstance->CharacterStats.Coins;
+	PlayTime = LoadGameInstance->CharacterStats.PlayTime;
 
-	if (WeaponStorage)
-	{
-		AItemStorage* Weapons = GetWorld()->SpawnActor<AItemStorage>(WeaponStorage);
-		if (Weapons)
-		{
-			FString WeaponName = LoadGameInstance->CharacterStats.WeaponName;
-			if (WeaponName != TEXT(""))
-			{
-				AWeapon* WeaponToEquip = GetWorld()->SpawnActor<AWeapon>(Weapons->WeaponMap[WeaponName]);
-				WeaponToEquip->Equip(this);
-			}			
-		}
-	}
+	EquipSavedWeapon(LoadGameInstance->CharacterStats.WeaponName);
 
 	if (SetPosition)
 	{
@@ -776,6 +972,17 @@ void AMainCharacter::LoadGame(bool SetPosition)
 	GetMesh()->bPauseAnims = false;
 	GetMesh()->bNoSkeletonUpdate = false;
 
+	// Every level has a world state of its own, the saved level's is applied once it has been entered
+	FString MapName = GetWorld()->GetMapName();
+	MapName.RemoveFromStart(GetWorld()->StreamingLevelsPrefix);
+	if (LoadGameInstance->CharacterStats.LevelName.IsEmpty() || LoadGameInstance->CharacterStats.LevelName == MapName)
+	{
+		LoadWorldState(LoadGameInstance->PlayerName);
+	}
+	else
+	{
+		PendingWorldStatePlayerName = LoadGameInstance->PlayerName;
+	}
 
 	if (LoadGameInstance->CharacterStats.LevelName != TEXT(""))
 	{
@@ -784,30 +991,105 @@ void AMainCharacter::LoadGame(bool SetPosition)
 	}
 }
 
+void AMainCharacter::EquipSavedWeapon(const FString& WeaponName)
+{
+	if (WeaponName.IsEmpty()) { return; }
+
+	const FName Name(*WeaponName);
+	PendingWeaponName = Name;
+
+	UPersistentPlayerSubsystem* PersistentPlayerSubsystem = UPersistentPlayerSubsystem::Get(this);
+	if (PersistentPlayerSubsystem && WeaponRegistry)
+	{
+		PersistentPlayerSubsystem->RequestWeaponClass(Name, WeaponRegistry, FOnWeaponClassLoaded::CreateUObject(this, &AMainCharacter::OnSavedWeaponLoaded, Name));
+	}
+	else if (PersistentPlayerSubsystem)
+	{
+		OnSavedWeaponLoaded(PersistentPlayerSubsystem->FindWeaponClass(Name, WeaponStorage), Name);
+	}
+	else if (WeaponRegistry)
+	{
+		OnSavedWeaponLoaded(WeaponRegistry->FindWeapon(Name).LoadSynchronous(), Name);
+	}
+}
+
+void AMainCharacter::OnSavedWeaponLoaded(TSubclassOf<AWeapon> WeaponClass, FName WeaponName)
+{
+	// A later load may have asked for another weapon while this one was loading
+	if (WeaponName != PendingWeaponName) { return; }
+	PendingWeaponName = NAME_None;
+
+	if (WeaponClass == nullptr) { return; }
+
+	// Loading the same save again must not pile up copies of the weapon already carried
+	if ((EquippedWeapon && EquippedWeapon->GetClass() == WeaponClass) || (UnequippedWeapon && UnequippedWeapon->GetClass() == WeaponClass)) { return; }
+
+	AWeapon* WeaponToEquip = GetWorld()->SpawnActor<AWeapon>(WeaponClass);
+	if (WeaponToEquip)
+	{
+		WeaponToEquip->Equip(this);
+	}
+}
+
+void AMainCharacter::LoadWorldState(const FString& PlayerName)
+{
+	AWorldStateManager* WorldStateManager = AWorldStateManager::Get(this);
+	if (WorldStateManager)
+	{
+		WorldStateManager->LoadWorldState(PlayerName);
+	}
+}
+
+void AMainCharacter::CaptureCheckpoint()
+{
+	UCheckpointSubsystem* CheckpointSubsystem = UCheckpointSubsystem::Get(this);
+	if (CheckpointSubsystem)
+	{
+		CheckpointSubsystem->CaptureCheckpoint(this);
+	}
+}
+
+bool AMainCharacter::RespawnFromCheckpoint()
+{
+	UCheckpointSubsystem* CheckpointSubsystem = UCheckpointSubsystem::Get(this);
+	return CheckpointSubsystem && CheckpointSubsystem->RestoreCheckpoint(this);
+}
+
 void AMainCharacter::LoadGameNoSwitch()
 {
-	UFirstSaveGame* LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::CreateSaveGameObject(UFirstSaveGame::StaticClass()));
-	LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::LoadGameFromSlot(LoadGameInstance->PlayerName, LoadGameInstance->UserIndex));
+	// The level was entered with the live state of the previous one, a slot on disk can only be older
+	if (bRestoredFromTransition)
+	{
+		bRestoredFromTransition = false;
+		return;
+	}
+
+	// The slot name and user index are class defaults, no need to create a save object to read them
+	const UFirstSaveGame* Defaults = GetDefault<UFirstSaveGame>();
+
+	// A save still being written is read back from memory
+	UFirstSaveGame* LoadGameInstance = nullptr;
+	USaveGameSubsystem* SaveGameSubsystem = USaveGameSubsystem::Get(this);
+	if (SaveGameSubsystem)
+	{
+		LoadGameInstance = Cast<UFirstSaveGame>(SaveGameSubsystem->LoadGame(Defaults->PlayerName, Defaults->UserIndex));
+	}
+	else
+	{
+		LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::LoadGameFromSlot(Defaults->PlayerName, Defaults->UserIndex));
+	}
+	if (LoadGameInstance == nullptr) { return; }
 
 	Health = LoadGameInstance->CharacterStats.Health;
 	MaxHealth = LoadGameInstance->CharacterStats.MaxHealth;
 	Stamina = LoadGameInstance->CharacterStats.Stamina;
 	MaxStamina = LoadGameInstance->CharacterStats.MaxStamina;
 	Coins = LoadGameInstance->CharacterStats.Coins;
+	PlayTime = LoadGameInstance->CharacterStats.PlayTime;
 
-	if (WeaponStorage)
-	{
-		AItemStorage* Weapons = GetWorld()->SpawnActor<AItemStorage>(WeaponStorage);
-		if (Weapons)
-		{
-			FString WeaponName = LoadGameInstance->CharacterStats.WeaponName;
-			if (WeaponName != TEXT(""))
-			{
-				AWeapon* WeaponToEquip = GetWorld()->SpawnActor<AWeapon>(Weapons->WeaponMap[WeaponName]);
-				WeaponToEquip->Equip(this);
-			}
-		}
-	}
+	EquipSavedWeapon(LoadGameInstance->CharacterStats.WeaponName);
+
+	LoadWorldState(LoadGameInstance->PlayerName);
 
 	SetMovementStatus(EMovementStatus::EMS_Normal);
 	GetMesh()->bPauseAnims = false;
@@ -108,11 +108,11 @@ public:
 
 	/** Particles emitted when hit */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
-	class UParticleSystem* HitParticles;
+	TSoftObjectPtr<class UParticleSystem> HitParticles;
 
 	/** Sound played when hit */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
-	class USoundCue* HitSound;
+	TSoftObjectPtr<class USoundCue> HitSound;
 
 	/** Sound played with Left Foot */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sounds")
@@ -135,10 +135,10 @@ public:
 	bool bInCombo;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Anims")
-	class UAnimMontage* CombatMontage;
+	TSoftObjectPtr<class UAnimMontage> CombatMontage;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Anims")
-	class UAnimMontage* UpperBodyMontage;
+	TSoftObjectPtr<UAnimMontage> UpperBodyMontage;
 
 	int32 Section;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Anims")
@@ -150,9 +150,38 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	TSubclassOf<AEnemy> EnemyFilter;
 
+	/** How strongly enemies behind the player are passed over when picking a combat target, 0 picks by distance alone */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	float TargetFacingWeight;
+
+	/** How strongly wounded enemies are preferred when picking a combat target */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	float TargetHealthWeight;
+
+	/** Enemies whose agro range contains the player, kept up to date from range events */
+	UPROPERTY()
+	TArray<AEnemy*> TargetCandidates;
+
+	/** Set once the player cycles targets, the chosen target is kept until it leaves range or dies */
+	bool bCombatTargetLocked;
+
+	/** This level was entered through a level transition and the character carried over from memory */
+	bool bRestoredFromTransition;
+
+	/** Weapons a save can refer to by name */
+	UPROPERTY(EditDefaultsOnly, Category = "SaveData")
+	class UWeaponRegistry* WeaponRegistry;
+
+	/** Only used while WeaponRegistry isn't set, its weapon classes are hard references and load with the character */
 	UPROPERTY(EditDefaultsOnly, Category = "SaveData")
 	TSubclassOf<class AItemStorage> WeaponStorage;
 
+	/** Saved weapon whose class is still loading, none once it is equipped */
+	FName PendingWeaponName;
+
+	/** Player whose saved world state the level LoadGame switches to gets once it has started */
+	FString PendingWorldStatePlayerName;
+
 	/**
 	/*
 	/* Player Stats
@@ -172,10 +201,16 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Stats")
 	int32 Coins;
 
+	/** Seconds played across sessions, carried in saves */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Player Stats")
+	float PlayTime;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -290,6 +325,15 @@ public:
 	
 	void UpdateCombatTarget();
 
+	void AddTargetCandidate(AEnemy* Enemy);
+	void RemoveTargetCandidate(AEnemy* Enemy);
+
+	/** Lower scores make better combat targets */
+	float ScoreTarget(const AEnemy* Enemy) const;
+
+	/** Switch to the next candidate in score order after the current target */
+	void CycleCombatTarget();
+
 	void SwitchLevel(FName LevelName);
 
 	UFUNCTION(BlueprintCallable)
@@ -297,6 +341,21 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void LoadGame(bool SetPosition);
 
+	/** Spawn and equip the weapon a save refers to by name, once its class has loaded */
+	void EquipSavedWeapon(const FString& WeaponName);
+
+	void OnSavedWeaponLoaded(TSubclassOf<AWeapon> WeaponClass, FName WeaponName);
+
+	/** Put the current level's pickups, enemies, switches and platforms in the state PlayerName's save holds */
+	void LoadWorldState(const FString& PlayerName);
+
+	/** Remember the current state in the in-memory checkpoint ring */
+	void CaptureCheckpoint();
+
+	/** Respawn in place at the newest checkpoint of this level, false if there is none and LoadGame is needed */
+	UFUNCTION(BlueprintCallable)
+	bool RespawnFromCheckpoint();
+
 	UFUNCTION(BlueprintCallable)
 	void LoadGameNoSwitch();
 };
\ No newline at end of file
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MeleeTraceManager.h"
+#include "WorldManagers.h"
+#include "Components/BoxComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMeshSocket.h"
+
+FMeleeSocket::FMeleeSocket()
+{
+	BoneIndex = INDEX_NONE;
+	LocalTransform = FTransform::Identity;
+}
+
+void FMeleeSocket::Init(const USkeletalMeshComponent* Mesh, FName SocketName)
+{
+	BoneIndex = INDEX_NONE;
+	if (Mesh == nullptr) { return; }
+
+	const USkeletalMeshSocket* Socket = Mesh->GetSocketByName(SocketName);
+	if (Socket)
+	{
+		BoneIndex = Mesh->GetBoneIndex(Socket->BoneName);
+		LocalTransform = Socket->GetSocketLocalTransform();
+	}
+}
+
+FVector FMeleeSocket::GetLocation(const USkeletalMeshComponent* Mesh) const
+{
+	if (!IsValid()) { return Mesh->GetComponentLocation(); }
+
+	return (LocalTransform * Mesh->GetBoneTransform(BoneIndex)).GetLocation();
+}
+
+// Sets default values
+AMeleeTraceManager::AMeleeTraceManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Swing boxes follow the animated pose, which is final once physics has run
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	MaxSubstepAngle = 15.f;
+	MaxSubsteps = 6;
+
+	NumActiveSwings = 0;
+	NumSweepsLastFrame = 0;
+	NumHitsLastFrame = 0;
+
+	NextSwingId = 1;
+	NumHitsSinceTick = 0;
+
+	SweepDelegate.BindUObject(this, &AMeleeTraceManager::OnSweepCompleted);
+}
+
+AMeleeTraceManager* AMeleeTraceManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<AMeleeTraceManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called every frame
+void AMeleeTraceManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	NumSweepsLastFrame = 0;
+	NumActiveSwings = 0;
+	NumHitsLastFrame = NumHitsSinceTick;
+	NumHitsSinceTick = 0;
+
+	for (int32 i = Swings.Num() - 1; i >= 0; i--)
+	{
+		FMeleeSwing& Swing = Swings[i];
+		UBoxComponent* Shape = Swing.Shape.Get();
+
+		if (Shape && !Swing.bEnded)
+		{
+			SweepSwing(Swing, Shape->GetComponentTransform());
+			Swing.bEnded = Swing.bEnding;
+			++NumActiveSwings;
+		}
+		else if (Swing.PendingSweeps == 0)
+		{
+			// Closed and every sweep has reported back
+			Swings.RemoveAtSwap(i);
+		}
+	}
+}
+
+int32 AMeleeTraceManager::BeginSwing(UBoxComponent* Shape, const TArray<AActor*>& IgnoredActors, FOnMeleeHit OnHit)
+{
+	if (Shape == nullptr) { return INDEX_NONE; }
+
+	FMeleeSwing& Swing = Swings.AddDefaulted_GetRef();
+	Swing.Id = NextSwingId++;
+	Swing.Shape = Shape;
+	Swing.LastTransform = Shape->GetComponentTransform();
+	Swing.QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(MeleeSweep), false);
+	Swing.QueryParams.AddIgnoredActors(IgnoredActors);
+	Swing.OnHit = OnHit;
+	Swing.PendingSweeps = 0;
+	Swing.bEnding = false;
+	Swing.bEnded = false;
+
+	return Swing.Id;
+}
+
+void AMeleeTraceManager::EndSwing(int32 SwingId)
+{
+	FMeleeSwing* Swing = FindSwing(SwingId);
+	if (Swing)
+	{
+		Swing->bEnding = true;
+	}
+}
+
+void AMeleeTraceManager::SweepSwing(FMeleeSwing& Swing, const FTransform& Transform)
+{
+	const FQuat StartRotation = Swing.LastTransform.GetRotation();
+	const FQuat EndRotation = Transform.GetRotation();
+	const FVector StartLocation = Swing.LastTransform.GetLocation();
+	const FVector EndLocation = Transform.GetLocation();
+
+	// The sweep only moves the box, so large rotations are covered by sweeping several smaller arcs
+	const float Angle = FMath::RadiansToDegrees(StartRotation.AngularDistance(EndRotation));
+	const int32 Substeps = FMath::Clamp(FMath::CeilToInt(Angle / MaxSubstepAngle), 1, MaxSubsteps);
+
+	const FCollisionShape Box = FCollisionShape::MakeBox(Swing.Shape->GetScaledBoxExtent());
+	const FCollisionObjectQueryParams ObjectParams(ECollisionChannel::ECC_Pawn);
+
+	FVector SegmentStart = StartLocation;
+	for (int32 Step = 1; Step <= Substeps; Step++)
+	{
+		const float Alpha = (float)Step / Substeps;
+		const FVector SegmentEnd = FMath::Lerp(StartLocation, EndLocation, Alpha);
+		const FQuat SegmentRotation = FQuat::Slerp(StartRotation, EndRotation, (Step - 0.5f) / Substeps);
+
+		GetWorld()->AsyncSweepByObjectType(EAsyncTraceType::Multi, SegmentStart, SegmentEnd, SegmentRotation, ObjectParams, Box, Swing.QueryParams, &SweepDelegate, Swing.Id);
+
+		++Swing.PendingSweeps;
+		++NumSweepsLastFrame;
+		SegmentStart = SegmentEnd;
+	}
+
+	Swing.LastTransform = Transform;
+}
+
+void AMeleeTraceManager::OnSweepCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	FMeleeSwing* Swing = FindSwing(Datum.UserData);
+	if (Swing == nullptr) { return; }
+
+	--Swing->PendingSweeps;
+
+	for (const FHitResult& Hit : Datum.OutHits)
+	{
+		AActor* HitActor = Hit.GetActor();
+		if (HitActor == nullptr || Swing->HitActors.Contains(HitActor)) { continue; }
+
+		Swing->HitActors.Add(HitActor);
+		++NumHitsSinceTick;
+
+		// The callback may start new swings and grow the array, so the swing is looked up again afterwards
+		FOnMeleeHit OnHit = Swing->OnHit;
+		OnHit.ExecuteIfBound(Hit);
+
+		Swing = FindSwing(Datum.UserData);
+		if (Swing == nullptr) { return; }
+	}
+}
+
+AMeleeTraceManager::FMeleeSwing* AMeleeTraceManager::FindSwing(int32 SwingId)
+{
+	return Swings.FindByPredicate([SwingId](const FMeleeSwing& Swing) { return Swing.Id == SwingId; });
+}
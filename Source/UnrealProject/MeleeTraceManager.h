@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+#include "MeleeTraceManager.generated.h"
+
+DECLARE_DELEGATE_OneParam(FOnMeleeHit, const FHitResult&);
+
+/** Socket resolved to a bone index once, so per-hit lookups don't search sockets by name */
+struct FMeleeSocket
+{
+	FMeleeSocket();
+
+	void Init(const class USkeletalMeshComponent* Mesh, FName SocketName);
+
+	bool IsValid() const { return BoneIndex != INDEX_NONE; }
+
+	FVector GetLocation(const USkeletalMeshComponent* Mesh) const;
+
+	int32 BoneIndex;
+	FTransform LocalTransform;
+};
+
+/**
+ * Melee hit detection for weapons and enemy fists.
+ * While a swing window is open the swing's box is swept from last frame's pose to this frame's,
+ * split into substeps when it rotated a lot, with all sweeps issued as one async batch.
+ * Each actor is reported at most once per swing, the boxes themselves never collide.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API AMeleeTraceManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AMeleeTraceManager();
+
+	static AMeleeTraceManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** Largest rotation covered by a single sweep, faster swings are split into more sweeps */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Melee Trace")
+	float MaxSubstepAngle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Melee Trace")
+	int32 MaxSubsteps;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Melee Trace | Stats")
+	int32 NumActiveSwings;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Melee Trace | Stats")
+	int32 NumSweepsLastFrame;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Melee Trace | Stats")
+	int32 NumHitsLastFrame;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	/** Start sweeping Shape every frame, OnHit is called once for every actor it touches. Returns the swing's id */
+	int32 BeginSwing(class UBoxComponent* Shape, const TArray<AActor*>& IgnoredActors, FOnMeleeHit OnHit);
+
+	/** Close the swing window, the box is swept one last time up to its current pose */
+	void EndSwing(int32 SwingId);
+
+private:
+	struct FMeleeSwing
+	{
+		int32 Id;
+		TWeakObjectPtr<UBoxComponent> Shape;
+		FTransform LastTransform;
+		FCollisionQueryParams QueryParams;
+		FOnMeleeHit OnHit;
+		TSet<TWeakObjectPtr<AActor>> HitActors;
+		int32 PendingSweeps;
+		bool bEnding;
+		bool bEnded;
+	};
+
+	void SweepSwing(FMeleeSwing& Swing, const FTransform& Transform);
+
+	void OnSweepCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	FMeleeSwing* FindSwing(int32 SwingId);
+
+	TArray<FMeleeSwing> Swings;
+
+	FTraceDelegate SweepDelegate;
+
+	int32 NextSwingId;
+
+	/** Hits come in from async sweeps before this manager ticks, counted here until then */
+	int32 NumHitsSinceTick;
+};
@@ -0,0 +1,220 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathQueryManager.h"
+#include "WorldManagers.h"
+#include "Enemy.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+
+// Sets default values
+APathQueryManager::APathQueryManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	StartTolerance = 150.f;
+	GoalTolerance = 100.f;
+	CorridorLifetime = 1.f;
+	MaxCorridorsPerGoal = 4;
+	MaxPathfindsPerFrame = 8;
+
+	NumRequestsLastFrame = 0;
+	NumPathfindsLastFrame = 0;
+	CacheHitRate = 0.f;
+	LastFrameQueryTimeMs = 0.f;
+	AverageQueryTimeMs = 0.f;
+
+	TotalHits = 0;
+	TotalPathfinds = 0;
+	TotalQuerySeconds = 0.0;
+}
+
+APathQueryManager* APathQueryManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<APathQueryManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called every frame
+void APathQueryManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	NumRequestsLastFrame = 0;
+	NumPathfindsLastFrame = 0;
+	LastFrameQueryTimeMs = 0.f;
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	for (auto It = Corridors.CreateIterator(); It; ++It)
+	{
+		It->Value.RemoveAll([this, Now](const FCachedCorridor& Corridor) { return Now - Corridor.Time > CorridorLifetime; });
+		if (!It->Key.IsValid() || It->Value.Num() == 0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	int32 PathfindBudget = MaxPathfindsPerFrame;
+
+	TArray<FPathRequest> Batch = MoveTemp(Requests);
+	Requests.Reset();
+
+	for (const FPathRequest& Request : Batch)
+	{
+		if (ProcessRequest(Request, PathfindBudget))
+		{
+			++NumRequestsLastFrame;
+		}
+		else
+		{
+			Requests.Add(Request);
+		}
+	}
+
+	const int32 TotalAnswered = TotalHits + TotalPathfinds;
+	CacheHitRate = TotalAnswered > 0 ? (float)TotalHits / TotalAnswered : 0.f;
+	AverageQueryTimeMs = TotalPathfinds > 0 ? (float)(TotalQuerySeconds * 1000.0 / TotalPathfinds) : 0.f;
+}
+
+void APathQueryManager::RequestPath(AEnemy* Enemy, AActor* Goal, float AcceptanceRadius)
+{
+	if (Enemy == nullptr || Goal == nullptr) { return; }
+
+	for (FPathRequest& Request : Requests)
+	{
+		if (Request.Enemy == Enemy)
+		{
+			Request.Goal = Goal;
+			Request.AcceptanceRadius = AcceptanceRadius;
+			return;
+		}
+	}
+
+	FPathRequest Request;
+	Request.Enemy = Enemy;
+	Request.Goal = Goal;
+	Request.AcceptanceRadius = AcceptanceRadius;
+	Requests.Add(Request);
+}
+
+bool APathQueryManager::ProcessRequest(const FPathRequest& Request, int32& PathfindBudget)
+{
+	AEnemy* Enemy = Request.Enemy.Get();
+	AActor* Goal = Request.Goal.Get();
+	if (Enemy == nullptr || Goal == nullptr || Enemy->AIController == nullptr) { return true; }
+
+	// The enemy may have reached combat range, lost the target or switched to the flow field since it asked
+	if (Enemy->EnemyMovementStatus != EEnemyMovementStatus::EMS_MoveToTarget || Enemy->bFollowingFlowField || Enemy->ChaseTarget != Goal) { return true; }
+
+	AAIController* AIController = Enemy->AIController;
+
+	FAIMoveRequest MoveRequest;
+	MoveRequest.SetGoalActor(Goal);
+	MoveRequest.SetAcceptanceRadius(Request.AcceptanceRadius);
+
+	FPathFindingQuery Query;
+	if (!AIController->BuildPathfindingQuery(MoveRequest, Query)) { return true; }
+
+	FNavPathSharedPtr Path = FindCachedPath(Goal, Query);
+	if (Path.IsValid())
+	{
+		++TotalHits;
+	}
+	else
+	{
+		if (PathfindBudget <= 0) { return false; }
+		--PathfindBudget;
+
+		UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+		if (NavSys == nullptr) { return true; }
+
+		const double StartTime = FPlatformTime::Seconds();
+		FPathFindingResult Result = NavSys->FindPathSync(Query);
+		const double QuerySeconds = FPlatformTime::Seconds() - StartTime;
+
+		++TotalPathfinds;
+		++NumPathfindsLastFrame;
+		TotalQuerySeconds += QuerySeconds;
+		LastFrameQueryTimeMs += (float)(QuerySeconds * 1000.0);
+
+		if (!Result.IsSuccessful()) { return true; }
+
+		Path = Result.Path;
+		if (!Path->IsPartial())
+		{
+			AddCorridor(Goal, *Path, Query);
+		}
+	}
+
+	Path->SetGoalActorObservation(*Goal, 100.f);
+	Path->EnableRecalculationOnInvalidation(true);
+	AIController->RequestMove(MoveRequest, Path);
+
+	return true;
+}
+
+FNavPathSharedPtr APathQueryManager::FindCachedPath(AActor* Goal, const FPathFindingQuery& Query) const
+{
+	const TArray<FCachedCorridor>* GoalCorridors = Corridors.Find(Goal);
+	const ANavigationData* NavData = Query.NavData.Get();
+	if (GoalCorridors == nullptr || NavData == nullptr) { return nullptr; }
+
+	const FVector Start = Query.StartLocation;
+
+	for (const FCachedCorridor& Corridor : *GoalCorridors)
+	{
+		if (FVector::DistSquared(Corridor.GoalLocation, Query.EndLocation) > FMath::Square(GoalTolerance)) { continue; }
+
+		// Navigation data hands out one shared filter per filter class, so equal pointers mean the same areas and costs
+		if (Corridor.QueryFilter != Query.QueryFilter) { continue; }
+
+		// Join as far along the corridor as possible, the joining point has to be in straight reach on the navmesh
+		const TArray<FNavPathPoint>& Points = Corridor.Points;
+		for (int32 i = Points.Num() - 2; i >= 0; i--)
+		{
+			const FVector Closest = FMath::ClosestPointOnSegment(Start, Points[i].Location, Points[i + 1].Location);
+			if (FVector::DistSquared(Closest, Start) > FMath::Square(StartTolerance)) { continue; }
+
+			FVector HitLocation;
+			if (NavData->Raycast(Start, Points[i + 1].Location, HitLocation, Query.QueryFilter, Query.Owner.Get())) { continue; }
+
+			FNavPathSharedPtr Path = MakeShareable(new FNavigationPath());
+			TArray<FNavPathPoint>& PathPoints = Path->GetPathPoints();
+			PathPoints.Reserve(Points.Num() - i);
+			PathPoints.Add(FNavPathPoint(Start));
+			for (int32 j = i + 1; j < Points.Num(); j++)
+			{
+				PathPoints.Add(Points[j]);
+			}
+
+			// Recalculating after the navmesh changes goes through the path's own filter
+			Path->SetNavigationDataUsed(NavData);
+			Path->SetFilter(Query.QueryFilter);
+			Path->SetQuerier(Query.Owner.Get());
+			Path->SetTimeStamp(GetWorld()->GetTimeSeconds());
+			Path->MarkReady();
+			return Path;
+		}
+	}
+
+	return nullptr;
+}
+
+void APathQueryManager::AddCorridor(AActor* Goal, const FNavigationPath& Path, const FPathFindingQuery& Query)
+{
+	TArray<FCachedCorridor>& GoalCorridors = Corridors.FindOrAdd(Goal);
+
+	// Oldest corridor makes room for the new one
+	if (GoalCorridors.Num() >= MaxCorridorsPerGoal && GoalCorridors.Num() > 0)
+	{
+		GoalCorridors.RemoveAt(0);
+	}
+
+	FCachedCorridor& Corridor = GoalCorridors.AddDefaulted_GetRef();
+	Corridor.Points = Path.GetPathPoints();
+	Corridor.GoalLocation = Query.EndLocation;
+	Corridor.QueryFilter = Query.QueryFilter;
+	Corridor.Time = GetWorld()->GetTimeSeconds();
+}
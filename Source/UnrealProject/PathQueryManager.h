@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "PathQueryManager.generated.h"
+
+/** Path found for one goal actor, reused by later requests that start on or near it */
+struct FCachedCorridor
+{
+	TArray<FNavPathPoint> Points;
+
+	/** Goal location the corridor was planned to */
+	FVector GoalLocation;
+
+	/** Filter the corridor was planned with, only requests using the same one can join it */
+	FSharedConstNavQueryFilter QueryFilter;
+
+	float Time;
+};
+
+/**
+ * Batches enemy path requests and runs them once per frame.
+ * Requests are answered from a cached corridor to the same goal actor when the start lies close to it
+ * and the goal hasn't moved much, so a group chasing the same player mostly shares a single pathfind.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API APathQueryManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	APathQueryManager();
+
+	static APathQueryManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** How far from a cached corridor a request may start and still join it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path Query")
+	float StartTolerance;
+
+	/** How far the goal may have moved since a corridor was planned before it is replanned */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path Query")
+	float GoalTolerance;
+
+	/** Seconds a corridor stays in the cache */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path Query")
+	float CorridorLifetime;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path Query")
+	int32 MaxCorridorsPerGoal;
+
+	/** Pathfinds allowed per frame, requests over budget wait for the next frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Path Query")
+	int32 MaxPathfindsPerFrame;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Path Query | Stats")
+	int32 NumRequestsLastFrame;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Path Query | Stats")
+	int32 NumPathfindsLastFrame;
+
+	/** Share of requests answered from the cache since the level started, 0 to 1 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Path Query | Stats")
+	float CacheHitRate;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Path Query | Stats")
+	float LastFrameQueryTimeMs;
+
+	/** Average time of a single pathfind since the level started */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Path Query | Stats")
+	float AverageQueryTimeMs;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	/** Queue a move for Enemy towards Goal, replaces any request the enemy already has pending */
+	void RequestPath(class AEnemy* Enemy, AActor* Goal, float AcceptanceRadius);
+
+private:
+	struct FPathRequest
+	{
+		TWeakObjectPtr<AEnemy> Enemy;
+		TWeakObjectPtr<AActor> Goal;
+		float AcceptanceRadius;
+	};
+
+	/** Returns false if the request has to wait for next frame's pathfind budget */
+	bool ProcessRequest(const FPathRequest& Request, int32& PathfindBudget);
+
+	/** Builds a path from the query's start joining one of Goal's corridors, null if none is close enough */
+	FNavPathSharedPtr FindCachedPath(AActor* Goal, const struct FPathFindingQuery& Query) const;
+
+	void AddCorridor(AActor* Goal, const FNavigationPath& Path, const FPathFindingQuery& Query);
+
+	TArray<FPathRequest> Requests;
+
+	TMap<TWeakObjectPtr<AActor>, TArray<FCachedCorridor>> Corridors;
+
+	int32 TotalHits;
+	int32 TotalPathfinds;
+	double TotalQuerySeconds;
+};
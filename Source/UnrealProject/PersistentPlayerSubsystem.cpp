@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PersistentPlayerSubsystem.h"
+#include "MainCharacter.h"
+#include "Weapon.h"
+#include "ItemStorage.h"
+#include "WeaponRegistry.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Misc/PackageName.h"
+#include "Sound/SoundCue.h"
+#include "Particles/ParticleSystem.h"
+#include "Animation/AnimMontage.h"
+
+UPersistentPlayerSubsystem::UPersistentPlayerSubsystem()
+{
+	NumTransitions = 0;
+	NumCachedAssets = 0;
+
+	bHasStoredState = false;
+}
+
+UPersistentPlayerSubsystem* UPersistentPlayerSubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<UPersistentPlayerSubsystem>() : nullptr;
+}
+
+void UPersistentPlayerSubsystem::StoreCharacter(const AMainCharacter* MainCharacter, FName LevelName)
+{
+	if (MainCharacter == nullptr) { return; }
+
+	FCharacterStats& Stats = StoredState.CharacterStats;
+	Stats.Health = MainCharacter->Health;
+	Stats.MaxHealth = MainCharacter->MaxHealth;
+	Stats.Stamina = MainCharacter->Stamina;
+	Stats.MaxStamina = MainCharacter->MaxStamina;
+	Stats.Coins = MainCharacter->Coins;
+	Stats.PlayTime = MainCharacter->PlayTime;
+
+	// OpenLevel takes a short name or a package path, the new world only knows its short name
+	Stats.LevelName = FPackageName::GetShortName(LevelName.ToString());
+
+	AWeapon* EquippedWeapon = MainCharacter->EquippedWeapon;
+	AWeapon* UnequippedWeapon = MainCharacter->UnequippedWeapon;
+	StoredState.EquippedWeaponClass = EquippedWeapon ? EquippedWeapon->GetClass() : nullptr;
+	StoredState.UnequippedWeaponClass = UnequippedWeapon ? UnequippedWeapon->GetClass() : nullptr;
+
+	for (AWeapon* Weapon : { EquippedWeapon, UnequippedWeapon })
+	{
+		if (Weapon == nullptr) { continue; }
+
+		WeaponClasses.Add(FName(*Weapon->Name), Weapon->GetClass());
+
+		CacheAsset(Weapon->GetClass());
+		CacheAsset(Weapon->OnEquipSound.Get());
+		CacheAsset(Weapon->SwingSound.Get());
+	}
+
+	CacheAsset(MainCharacter->HitParticles.Get());
+	CacheAsset(MainCharacter->HitSound.Get());
+	CacheAsset(MainCharacter->CombatMontage.Get());
+	CacheAsset(MainCharacter->UpperBodyMontage.Get());
+	CacheAsset(MainCharacter->LeftFootSound);
+	CacheAsset(MainCharacter->RightFootSound);
+
+	// Set while a save loaded right before the transition is still loading its weapon
+	StoredState.PendingWeaponName = MainCharacter->PendingWeaponName;
+	StoredState.WorldStatePlayerName = MainCharacter->PendingWorldStatePlayerName;
+
+	bHasStoredState = true;
+}
+
+bool UPersistentPlayerSubsystem::RestoreCharacter(AMainCharacter* MainCharacter)
+{
+	if (MainCharacter == nullptr || !bHasStoredState) { return false; }
+
+	UWorld* World = MainCharacter->GetWorld();
+	FString MapName = World->GetMapName();
+	MapName.RemoveFromStart(World->StreamingLevelsPrefix);
+
+	// A state left over from a transition that never happened must not leak into a level opened some other way
+	bHasStoredState = false;
+	const FCharacterStats& Stats = StoredState.CharacterStats;
+	if (Stats.LevelName != MapName) { return false; }
+
+	MainCharacter->Health = Stats.Health;
+	MainCharacter->MaxHealth = Stats.MaxHealth;
+	MainCharacter->Stamina = Stats.Stamina;
+	MainCharacter->MaxStamina = Stats.MaxStamina;
+	MainCharacter->Coins = Stats.Coins;
+	MainCharacter->PlayTime = Stats.PlayTime;
+	MainCharacter->PendingWorldStatePlayerName = StoredState.WorldStatePlayerName;
+
+	// The weapon of a save loaded right before the transition replaces the ones that were carried
+	if (!StoredState.PendingWeaponName.IsNone())
+	{
+		MainCharacter->EquipSavedWeapon(StoredState.PendingWeaponName.ToString());
+	}
+	else
+	{
+		if (StoredState.UnequippedWeaponClass)
+		{
+			AWeapon* WeaponToCarry = World->SpawnActor<AWeapon>(StoredState.UnequippedWeaponClass);
+			if (WeaponToCarry)
+			{
+				WeaponToCarry->Equip(MainCharacter);
+				WeaponToCarry->Unequip(MainCharacter);
+			}
+		}
+		if (StoredState.EquippedWeaponClass)
+		{
+			AWeapon* WeaponToEquip = World->SpawnActor<AWeapon>(StoredState.EquippedWeaponClass);
+			if (WeaponToEquip)
+			{
+				WeaponToEquip->Equip(MainCharacter);
+			}
+		}
+	}
+
+	++NumTransitions;
+	return true;
+}
+
+void UPersistentPlayerSubsystem::RequestWeaponClass(FName WeaponName, const UWeaponRegistry* Registry, FOnWeaponClassLoaded Delegate)
+{
+	const TSubclassOf<AWeapon>* Cached = WeaponClasses.Find(WeaponName);
+	if (Cached)
+	{
+		Delegate.ExecuteIfBound(*Cached);
+		return;
+	}
+
+	const TSoftClassPtr<AWeapon> WeaponClass = Registry ? Registry->FindWeapon(WeaponName) : TSoftClassPtr<AWeapon>();
+	if (WeaponClass.IsNull() || WeaponClass.Get())
+	{
+		OnWeaponClassLoaded(WeaponName, WeaponClass, Delegate);
+		return;
+	}
+
+	UAssetManager::GetStreamableManager().RequestAsyncLoad(WeaponClass.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &UPersistentPlayerSubsystem::OnWeaponClassLoaded, WeaponName, WeaponClass, Delegate));
+}
+
+void UPersistentPlayerSubsystem::OnWeaponClassLoaded(FName WeaponName, TSoftClassPtr<AWeapon> WeaponClass, FOnWeaponClassLoaded Delegate)
+{
+	UClass* Loaded = WeaponClass.Get();
+	if (Loaded)
+	{
+		WeaponClasses.Add(WeaponName, Loaded);
+		CacheAsset(Loaded);
+	}
+	Delegate.ExecuteIfBound(Loaded);
+}
+
+TSubclassOf<AWeapon> UPersistentPlayerSubsystem::FindWeaponClass(FName WeaponName, TSubclassOf<AItemStorage> WeaponStorage)
+{
+	if (WeaponName.IsNone()) { return nullptr; }
+
+	const TSubclassOf<AWeapon>* Cached = WeaponClasses.Find(WeaponName);
+	if (Cached) { return *Cached; }
+	if (WeaponStorage == nullptr) { return nullptr; }
+
+	// WeaponMap is only ever set on the class defaults, no need to spawn the storage to read it
+	const TSubclassOf<AWeapon>* WeaponClass = WeaponStorage->GetDefaultObject<AItemStorage>()->WeaponMap.Find(WeaponName.ToString());
+	if (WeaponClass == nullptr || *WeaponClass == nullptr) { return nullptr; }
+
+	WeaponClasses.Add(WeaponName, *WeaponClass);
+	CacheAsset(*WeaponClass);
+	return *WeaponClass;
+}
+
+void UPersistentPlayerSubsystem::CacheAsset(UObject* Asset)
+{
+	if (Asset == nullptr) { return; }
+
+	CachedAssets.Add(Asset);
+	NumCachedAssets = CachedAssets.Num();
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "FirstSaveGame.h"
+#include "PersistentPlayerSubsystem.generated.h"
+
+DECLARE_DELEGATE_OneParam(FOnWeaponClassLoaded, TSubclassOf<class AWeapon> /* WeaponClass */);
+
+/** Live character state handed from one level to the next */
+USTRUCT()
+struct FPersistentPlayerState
+{
+	GENERATED_BODY()
+
+	/** LevelName is the level the state is waiting for */
+	UPROPERTY()
+	FCharacterStats CharacterStats;
+
+	UPROPERTY()
+	TSubclassOf<AWeapon> EquippedWeaponClass;
+
+	UPROPERTY()
+	TSubclassOf<AWeapon> UnequippedWeaponClass;
+
+	/** Saved weapon the character was still loading, equipped by name in the new level in place of the carried ones */
+	UPROPERTY()
+	FName PendingWeaponName;
+
+	/** Player whose saved world state is applied to the new level, empty unless the transition comes from loading a save */
+	UPROPERTY()
+	FString WorldStatePlayerName;
+
+	FPersistentPlayerState()
+	{
+		EquippedWeaponClass = nullptr;
+		UnequippedWeaponClass = nullptr;
+	}
+};
+
+/**
+ * Carries the player across level transitions without going through a save slot.
+ * The character is stored right before the level opens and the new level's character picks it up in BeginPlay.
+ * Also keeps weapon classes and the player's sounds and particles referenced, so they aren't unloaded and loaded again with every level.
+ */
+UCLASS()
+class UNREALPROJECT_API UPersistentPlayerSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPersistentPlayerSubsystem();
+
+	static UPersistentPlayerSubsystem* Get(const UObject* WorldContextObject);
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Persistence | Stats")
+	int32 NumTransitions;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Persistence | Stats")
+	int32 NumCachedAssets;
+
+	/** Remember MainCharacter's live state for the character that spawns in LevelName */
+	void StoreCharacter(const class AMainCharacter* MainCharacter, FName LevelName);
+
+	/** Apply the stored state if it was stored for the current level, false if there was none */
+	bool RestoreCharacter(AMainCharacter* MainCharacter);
+
+	bool HasStoredCharacter() const { return bHasStoredState; }
+
+	/**
+	 * Load the class Registry lists under WeaponName in the background and hand it to Delegate, null if there is none.
+	 * Classes loaded before are cached and handed over right away.
+	 */
+	void RequestWeaponClass(FName WeaponName, const class UWeaponRegistry* Registry, FOnWeaponClassLoaded Delegate);
+
+	/** Weapon class saved under WeaponName, looked up in the WeaponStorage defaults the first time and cached after */
+	TSubclassOf<AWeapon> FindWeaponClass(FName WeaponName, TSubclassOf<class AItemStorage> WeaponStorage);
+
+	/** Keep Asset loaded for the rest of the session */
+	void CacheAsset(UObject* Asset);
+
+private:
+	void OnWeaponClassLoaded(FName WeaponName, TSoftClassPtr<AWeapon> WeaponClass, FOnWeaponClassLoaded Delegate);
+
+	UPROPERTY()
+	FPersistentPlayerState StoredState;
+
+	bool bHasStoredState;
+
+	UPROPERTY()
+	TMap<FName, TSubclassOf<AWeapon>> WeaponClasses;
+
+	UPROPERTY()
+	TSet<UObject*> CachedAssets;
+};
@@ -3,9 +3,13 @@
 
 #include "Pickup.h"
 #include "MainCharacter.h"
+#include "FXPool.h"
+#include "WorldStateManager.h"
+#include "AssetStreamingSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "Engine/World.h"
 #include "Sound/SoundCue.h"
+#include "Particles/ParticleSystem.h"
 
 APickup::APickup()
 {
@@ -23,13 +27,25 @@ void APickup::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* O
 			OnPickupBP(MainCharacter);
 			MainCharacter->PickupLocations.Add(GetActorLocation());
 
-			if (OverlapParticles)
+			UParticleSystem* Particles = UAssetStreamingSubsystem::Resolve(this, OverlapParticles);
+			if (Particles)
 			{
-				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), OverlapParticles, GetActorLocation(), FRotator(0.f), true);
+				AFXPool* FXPool = AFXPool::Get(this);
+				if (FXPool)
+				{
+					FXPool->SpawnEffect(Particles, GetActorLocation(), FRotator(0.f), EFXPriority::FXP_High);
+				}
 			}
-			if (OverlapSound)
+			USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, OverlapSound);
+			if (Sound)
 			{
-				UGameplayStatics::PlaySound2D(this, OverlapSound);
+				UGameplayStatics::PlaySound2D(this, Sound);
+			}
+
+			AWorldStateManager* WorldStateManager = AWorldStateManager::Get(this, false);
+			if (WorldStateManager)
+			{
+				WorldStateManager->MarkChanged(this);
 			}
 
 			Destroy();
@@ -0,0 +1,318 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SaveGameSubsystem.h"
+#include "UnrealProject.h"
+#include "FirstSaveGame.h"
+#include "Engine/GameInstance.h"
+#include "Kismet/GameplayStatics.h"
+#include "Async/Async.h"
+#include "PlatformFeatures.h"
+#include "SaveGameSystem.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+const FString USaveGameSubsystem::SlotIndexName = TEXT("SlotIndex");
+
+static FString GetBackupPath(const FString& SlotPath)
+{
+	return SlotPath + TEXT(".bak");
+}
+
+USaveGameSubsystem::USaveGameSubsystem()
+{
+	NumSavesWritten = 0;
+	NumSavesCoalesced = 0;
+	LastWriteTimeMs = 0.f;
+
+	NextWriteSerial = 1;
+}
+
+USaveGameSubsystem* USaveGameSubsystem::Get(const UObject* WorldContextObject)
+{
+	UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance ? GameInstance->GetSubsystem<USaveGameSubsystem>() : nullptr;
+}
+
+void USaveGameSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (UGameplayStatics::DoesSaveGameExist(SlotIndexName, 0))
+	{
+		USaveSlotIndex* SlotIndex = Cast<USaveSlotIndex>(UGameplayStatics::LoadGameFromSlot(SlotIndexName, 0));
+		if (SlotIndex)
+		{
+			SlotInfos = SlotIndex->Slots;
+		}
+	}
+}
+
+void USaveGameSubsystem::Deinitialize()
+{
+	// Quitting must not lose a save that is still queued
+	Flush();
+
+	Super::Deinitialize();
+}
+
+void USaveGameSubsystem::SaveGameAsync(USaveGame* SaveGameObject, const FString& SlotName)
+{
+	if (SaveGameObject == nullptr) { return; }
+
+	FSaveSlotQueue& Queue = Slots.FindOrAdd(SlotName);
+	if (Queue.Writing)
+	{
+		if (Queue.Next)
+		{
+			++NumSavesCoalesced;
+		}
+		Queue.Next = SaveGameObject;
+		return;
+	}
+
+	Queue.Writing = SaveGameObject;
+	StartWrite(SlotName);
+}
+
+USaveGame* USaveGameSubsystem::LoadGame(const FString& SlotName, int32 UserIndex)
+{
+	const FSaveSlotQueue* Queue = Slots.Find(SlotName);
+	if (Queue)
+	{
+		if (Queue->Next) { return Queue->Next; }
+		if (Queue->Writing) { return Queue->Writing; }
+	}
+
+	USaveGame* SaveGameObject = UGameplayStatics::LoadGameFromSlot(SlotName, UserIndex);
+
+#if PLATFORM_DESKTOP
+	// A write cut short between moving the old slot aside and moving the new one in leaves only the backup
+	TArray<uint8> Data;
+	if (SaveGameObject == nullptr && FFileHelper::LoadFileToArray(Data, *GetBackupPath(GetSlotPath(SlotName)), FILEREAD_Silent))
+	{
+		SaveGameObject = UGameplayStatics::LoadGameFromMemory(Data);
+	}
+#endif
+
+	return SaveGameObject;
+}
+
+const FSaveSlotInfo* USaveGameSubsystem::FindSlotInfo(const FString& SlotName) const
+{
+	return SlotInfos.FindByPredicate([&SlotName](const FSaveSlotInfo& Info) { return Info.SlotName == SlotName; });
+}
+
+bool USaveGameSubsystem::IsSlotCorrupt(const FString& SlotName, bool bVerifyChecksum) const
+{
+#if PLATFORM_DESKTOP
+	const FSaveSlotInfo* Info = FindSlotInfo(SlotName);
+	if (Info == nullptr) { return false; }
+
+	const FString Path = GetSlotPath(SlotName);
+	if (IFileManager::Get().FileSize(*Path) != Info->Size) { return true; }
+	if (!bVerifyChecksum) { return false; }
+
+	TArray<uint8> Data;
+	return !FFileHelper::LoadFileToArray(Data, *Path) || FCrc::MemCrc32(Data.GetData(), Data.Num()) != Info->Checksum;
+#else
+	// Slots aren't plain files here, the platform's save game system checks its own data
+	return false;
+#endif
+}
+
+bool USaveGameSubsystem::IsSaving() const
+{
+	return Writes.Num() > 0;
+}
+
+void USaveGameSubsystem::Flush()
+{
+	// Finishing a write starts the next coalesced one, so keep going until nothing is left
+	while (Writes.Num() > 0)
+	{
+		auto It = Writes.CreateIterator();
+		const FString SlotName = It->Key;
+		TFuture<FSaveGameWriteResult> Write = MoveTemp(It->Value);
+		It.RemoveCurrent();
+
+		const FSaveGameWriteResult Result = Write.Get();
+		const FSaveSlotQueue* Queue = Slots.Find(SlotName);
+		if (Queue)
+		{
+			OnWriteFinished(SlotName, Queue->WriteSerial, Result);
+		}
+	}
+}
+
+FString USaveGameSubsystem::GetSlotPath(const FString& SlotName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("SaveGames") / SlotName + TEXT(".sav");
+}
+
+bool USaveGameSubsystem::WriteSaveGame(USaveGame* SaveGameObject, const FString& SlotName, uint32* OutChecksum, int32* OutSize)
+{
+	TArray<uint8> Data;
+	if (!UGameplayStatics::SaveGameToMemory(SaveGameObject, Data)) { return false; }
+
+	if (OutChecksum)
+	{
+		*OutChecksum = FCrc::MemCrc32(Data.GetData(), Data.Num());
+	}
+	if (OutSize)
+	{
+		*OutSize = Data.Num();
+	}
+
+#if PLATFORM_DESKTOP
+	const FString Path = GetSlotPath(SlotName);
+	const FString TempPath = Path + TEXT(".tmp");
+	const FString BackupPath = GetBackupPath(Path);
+	if (!FFileHelper::SaveArrayToFile(Data, *TempPath)) { return false; }
+
+	// Moving over an existing file isn't atomic everywhere, so the old slot is moved aside first.
+	// A crash at any point leaves either the complete old slot, its backup, or the complete new slot
+	IFileManager& FileManager = IFileManager::Get();
+	if (FileManager.FileExists(*Path) && !FileManager.Move(*BackupPath, *Path, true, true)) { return false; }
+	if (!FileManager.Move(*Path, *TempPath, true, true)) { return false; }
+	FileManager.Delete(*BackupPath, false, false, true);
+	return true;
+#else
+	// Consoles and mobile keep saves in their own storage, which replaces a slot as a whole
+	ISaveGameSystem* SaveSystem = IPlatformFeaturesModule::Get().GetSaveGameSystem();
+	return SaveSystem && SaveSystem->SaveGame(false, *SlotName, 0, Data);
+#endif
+}
+
+void USaveGameSubsystem::StartWrite(const FString& SlotName)
+{
+	FSaveSlotQueue& Queue = Slots.FindChecked(SlotName);
+	Queue.WriteSerial = NextWriteSerial++;
+
+	// The queue keeps the object referenced until the write has finished, so it can't be collected meanwhile
+	USaveGame* SaveGameObject = Queue.Writing;
+	const int32 WriteSerial = Queue.WriteSerial;
+	TWeakObjectPtr<USaveGameSubsystem> WeakThis(this);
+
+	Writes.Add(SlotName, Async(EAsyncExecution::ThreadPool, [SaveGameObject, SlotName, WriteSerial, WeakThis]()
+	{
+		FSaveGameWriteResult Result;
+		Result.Checksum = 0;
+		Result.Size = 0;
+
+		const double StartTime = FPlatformTime::Seconds();
+		Result.bSuccess = WriteSaveGame(SaveGameObject, SlotName, &Result.Checksum, &Result.Size);
+		Result.WriteTimeMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+		AsyncTask(ENamedThreads::GameThread, [SlotName, WriteSerial, Result, WeakThis]()
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->OnWriteFinished(SlotName, WriteSerial, Result);
+			}
+		});
+
+		return Result;
+	}));
+}
+
+void USaveGameSubsystem::OnWriteFinished(const FString& SlotName, int32 WriteSerial, const FSaveGameWriteResult& Result)
+{
+	FSaveSlotQueue* Queue = Slots.Find(SlotName);
+	if (Queue == nullptr || Queue->Writing == nullptr || Queue->WriteSerial != WriteSerial) { return; }
+
+	Writes.Remove(SlotName);
+
+	if (Result.bSuccess)
+	{
+		++NumSavesWritten;
+
+		const UFirstSaveGame* PlayerSave = Cast<UFirstSaveGame>(Queue->Writing);
+		if (PlayerSave)
+		{
+			UpdateSlotIndex(SlotName, PlayerSave, Result);
+
+			// Queuing the index may have grown Slots
+			Queue = &Slots.FindChecked(SlotName);
+		}
+	}
+	LastWriteTimeMs = Result.WriteTimeMs;
+
+	if (Queue->Next)
+	{
+		Queue->Writing = Queue->Next;
+		Queue->Next = nullptr;
+		StartWrite(SlotName);
+	}
+	else
+	{
+		Slots.Remove(SlotName);
+	}
+
+	OnSaveGameWritten.Broadcast(SlotName, Result.bSuccess);
+}
+
+void USaveGameSubsystem::UpdateSlotIndex(const FString& SlotName, const UFirstSaveGame* SaveGameObject, const FSaveGameWriteResult& Result)
+{
+	FSaveSlotInfo* Info = SlotInfos.FindByPredicate([&SlotName](const FSaveSlotInfo& SlotInfo) { return SlotInfo.SlotName == SlotName; });
+	if (Info == nullptr)
+	{
+		Info = &SlotInfos.AddDefaulted_GetRef();
+		Info->SlotName = SlotName;
+	}
+
+	const FCharacterStats& Stats = SaveGameObject->CharacterStats;
+	Info->LevelName = Stats.LevelName;
+	Info->PlayTime = Stats.PlayTime;
+	Info->Coins = Stats.Coins;
+	Info->WeaponName = Stats.WeaponName;
+	Info->Timestamp = FDateTime::UtcNow();
+	Info->Checksum = Result.Checksum;
+	Info->Size = Result.Size;
+
+	// Written right behind the slot the same way, a crash in between leaves the old entry
+	// and IsSlotCorrupt() reports the slot until it is saved again
+	USaveSlotIndex* SlotIndex = Cast<USaveSlotIndex>(UGameplayStatics::CreateSaveGameObject(USaveSlotIndex::StaticClass()));
+	SlotIndex->Slots = SlotInfos;
+	SaveGameAsync(SlotIndex, SlotIndexName);
+}
+
+static void RunSaveGameBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+	const FString SlotName = TEXT("SaveGameBenchmark");
+
+	UFirstSaveGame* SaveGameObject = Cast<UFirstSaveGame>(UGameplayStatics::CreateSaveGameObject(UFirstSaveGame::StaticClass()));
+
+	TArray<uint8> Data;
+	UGameplayStatics::SaveGameToMemory(SaveGameObject, Data);
+
+	const double WriteStart = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; i++)
+	{
+		USaveGameSubsystem::WriteSaveGame(SaveGameObject, SlotName);
+	}
+	const double WriteSeconds = FPlatformTime::Seconds() - WriteStart;
+
+	const double ReadStart = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; i++)
+	{
+		UGameplayStatics::LoadGameFromSlot(SlotName, 0);
+	}
+	const double ReadSeconds = FPlatformTime::Seconds() - ReadStart;
+
+	UGameplayStatics::DeleteGameInSlot(SlotName, 0);
+
+	const double Megabytes = (double)Data.Num() * Iterations / (1024.0 * 1024.0);
+	UE_LOG(LogUnrealProject, Display, TEXT("SaveGame.Benchmark: %d x %d bytes, save %.3f ms (%.2f MB/s), load %.3f ms (%.2f MB/s)"),
+		Iterations, Data.Num(),
+		WriteSeconds * 1000.0 / Iterations, Megabytes / FMath::Max(WriteSeconds, SMALL_NUMBER),
+		ReadSeconds * 1000.0 / Iterations, Megabytes / FMath::Max(ReadSeconds, SMALL_NUMBER));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SaveGameBenchmarkCommand(
+	TEXT("SaveGame.Benchmark"),
+	TEXT("Times synchronous save and load round trips through a scratch slot. Usage: SaveGame.Benchmark [Iterations]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunSaveGameBenchmark));
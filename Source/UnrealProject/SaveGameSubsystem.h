@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Async/Future.h"
+#include "FirstSaveGame.h"
+#include "SaveGameSubsystem.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSaveGameWritten, const FString&, SlotName, bool, bSuccess);
+
+/** Saves of one slot, the one being written and the newest one waiting behind it */
+USTRUCT()
+struct FSaveSlotQueue
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	class USaveGame* Writing;
+
+	UPROPERTY()
+	USaveGame* Next;
+
+	/** Tells a finished write apart from one that Flush() already handled */
+	int32 WriteSerial;
+
+	FSaveSlotQueue()
+	{
+		Writing = nullptr;
+		Next = nullptr;
+		WriteSerial = 0;
+	}
+};
+
+/** Outcome of one background write */
+struct FSaveGameWriteResult
+{
+	bool bSuccess;
+	float WriteTimeMs;
+	uint32 Checksum;
+	int32 Size;
+};
+
+/**
+ * Writes save games without stalling the game thread.
+ * The caller hands over a filled in save object, serializing and writing happen on the thread pool.
+ * On desktop the data goes to a temp file and the old slot is kept as a backup until the new one is in place,
+ * so there is always a complete slot or backup to load. Other platforms write through their own save game system.
+ * Saves requested while the slot is being written are coalesced, only the newest of them is written next.
+ */
+UCLASS()
+class UNREALPROJECT_API USaveGameSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	USaveGameSubsystem();
+
+	static USaveGameSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Broadcast on the game thread once a save reached disk, or failed to */
+	UPROPERTY(BlueprintAssignable, Category = "Save Game")
+	FOnSaveGameWritten OnSaveGameWritten;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Save Game | Stats")
+	int32 NumSavesWritten;
+
+	/** Saves replaced by a newer one before they were written */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Save Game | Stats")
+	int32 NumSavesCoalesced;
+
+	/** Background time of the last write, serializing included */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Save Game | Stats")
+	float LastWriteTimeMs;
+
+	/** Queue SaveGameObject to be written to SlotName, the object must not be changed afterwards */
+	void SaveGameAsync(USaveGame* SaveGameObject, const FString& SlotName);
+
+	/** The newest save of SlotName, taken from memory while it is still being written, or from its backup if a write was cut short */
+	USaveGame* LoadGame(const FString& SlotName, int32 UserIndex);
+
+	/** Every indexed slot, read from memory without touching the slots themselves */
+	UFUNCTION(BlueprintCallable, Category = "Save Game")
+	TArray<FSaveSlotInfo> GetSlotInfos() const { return SlotInfos; }
+
+	const FSaveSlotInfo* FindSlotInfo(const FString& SlotName) const;
+
+	/**
+	 * Compare the slot file against its index entry without deserializing it.
+	 * The size check only stats the file, bVerifyChecksum also reads it to compare the CRC.
+	 * Slots missing from the index are assumed to be fine, and so is every slot on platforms without slot files.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Save Game")
+	bool IsSlotCorrupt(const FString& SlotName, bool bVerifyChecksum) const;
+
+	bool IsSaving() const;
+
+	/** Block until every queued save is on disk */
+	void Flush();
+
+	/** Where the slot lives on disk, the same file UGameplayStatics reads. Only desktop platforms keep slots as plain files */
+	static FString GetSlotPath(const FString& SlotName);
+
+	/** Serialize SaveGameObject and replace SlotName with it, safe to call off the game thread */
+	static bool WriteSaveGame(USaveGame* SaveGameObject, const FString& SlotName, uint32* OutChecksum = nullptr, int32* OutSize = nullptr);
+
+	/** Slot the index itself is stored in */
+	static const FString SlotIndexName;
+
+private:
+	void StartWrite(const FString& SlotName);
+
+	void OnWriteFinished(const FString& SlotName, int32 WriteSerial, const FSaveGameWriteResult& Result);
+
+	/** Record a player save that reached disk and queue the index to be written after it */
+	void UpdateSlotIndex(const FString& SlotName, const UFirstSaveGame* SaveGameObject, const FSaveGameWriteResult& Result);
+
+	UPROPERTY()
+	TMap<FString, FSaveSlotQueue> Slots;
+
+	/** Running writes, completed through a game thread task or by Flush() */
+	TMap<FString, TFuture<FSaveGameWriteResult>> Writes;
+
+	/** Loaded once, then kept in step with every player save */
+	TArray<FSaveSlotInfo> SlotInfos;
+
+	int32 NextWriteSerial;
+};
@@ -3,18 +3,27 @@
 
 #include "SpawnVolume.h"
 #include "Enemy.h"
+#include "EnemyPool.h"
+#include "EnemyRegionManager.h"
+#include "HordeManager.h"
+#include "WorldStateManager.h"
 #include "AIController.h"
 #include "Components/BoxComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Engine/World.h"
+#include "TimerManager.h"
 
 // Sets default values
 ASpawnVolume::ASpawnVolume()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	SpawningBox = CreateDefaultSubobject<UBoxComponent>(TEXT("SpawningBox"));
+
+	PoolPrewarmCount = 4;
+	bHasSpawned = false;
+	bSpawnedInLoadedSave = false;
 }
 
 // Called when the game starts or when spawned
@@ -29,6 +38,26 @@ void ASpawnVolume::BeginPlay()
 		SpawnArray.Add(Actor_3);
 		SpawnArray.Add(Actor_4);
 	}
+
+	// Wait a frame so pooled enemies are spawned into a world that has begun play
+	GetWorldTimerManager().SetTimerForNextTick(this, &ASpawnVolume::PrewarmEnemyPool);
+
+	AEnemyRegionManager* EnemyRegionManager = AEnemyRegionManager::Get(this);
+	if (EnemyRegionManager)
+	{
+		EnemyRegionManager->RegisterVolume(this);
+	}
+}
+
+void ASpawnVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AEnemyRegionManager* EnemyRegionManager = AEnemyRegionManager::Get(this, false);
+	if (EnemyRegionManager)
+	{
+		EnemyRegionManager->UnregisterVolume(this, EndPlayReason);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -62,27 +91,73 @@ TSubclassOf<AActor> ASpawnVolume::GetSpawnActor()
 
 void ASpawnVolume::SpawnOurActor_Implementation(UClass* ToSpawn, const FVector& Location)
 {
+	if (bSpawnedInLoadedSave) { return; }
+
 	if (ToSpawn)
 	{
+		if (!bHasSpawned)
+		{
+			bHasSpawned = true;
+
+			AWorldStateManager* WorldStateManager = AWorldStateManager::Get(this, false);
+			if (WorldStateManager)
+			{
+				WorldStateManager->MarkChanged(this);
+			}
+		}
+
 		UWorld* World = GetWorld();
-		FActorSpawnParameters SpawnParams;
 
 		if (World)
 		{
-			AActor* Actor = World->SpawnActor<AActor>(ToSpawn, Location, FRotator(0.f));
-			AEnemy* Enemy = Cast<AEnemy>(Actor);
-
-			if (Enemy)
+			if (ToSpawn->IsChildOf(AEnemy::StaticClass()))
 			{
-				Enemy->SpawnDefaultController();
-
-				AAIController* AIController = Cast<AAIController>(Enemy->GetController());
-				if (AIController)
+				// Only spawned while the player is near, otherwise kept as a record until the region activates
+				AEnemyRegionManager* EnemyRegionManager = AEnemyRegionManager::Get(this);
+				if (EnemyRegionManager)
+				{
+					EnemyRegionManager->SpawnEnemy(this, ToSpawn, Location, FRotator(0.f));
+				}
+				else
 				{
-					Enemy->AIController = AIController;
+					AEnemyPool* EnemyPool = AEnemyPool::Get(this);
+					if (EnemyPool)
+					{
+						EnemyPool->Acquire(ToSpawn, Location, FRotator(0.f));
+					}
 				}
 			}
+			else
+			{
+				World->SpawnActor<AActor>(ToSpawn, Location, FRotator(0.f));
+			}
 		}
 	}
 }
 
+void ASpawnVolume::PrewarmEnemyPool()
+{
+	AEnemyPool* EnemyPool = AEnemyPool::Get(this);
+	if (EnemyPool == nullptr) { return; }
+
+	for (TSubclassOf<AActor> SpawnClass : SpawnArray)
+	{
+		if (SpawnClass && SpawnClass->IsChildOf(AEnemy::StaticClass()))
+		{
+			EnemyPool->Prewarm(*SpawnClass, PoolPrewarmCount, GetActorLocation());
+		}
+	}
+}
+
+void ASpawnVolume::SpawnHorde(UClass* ToSpawn, int32 Count)
+{
+	if (ToSpawn == nullptr || !ToSpawn->IsChildOf(AEnemy::StaticClass())) { return; }
+
+	AHordeManager* HordeManager = AHordeManager::Get(this);
+	if (HordeManager == nullptr) { return; }
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		HordeManager->AddAgent(ToSpawn, GetSpawnPoint());
+	}
+}
@@ -32,10 +32,24 @@ public:
 
 	TArray<TSubclassOf<AActor>> SpawnArray;
 
+	/** Enemies of each spawnable class parked in the enemy pool when the level starts */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning")
+	int32 PoolPrewarmCount;
+
+	/** Spawned something at least once, kept in the world state save so level scripts can skip spawning again */
+	UPROPERTY(BlueprintReadOnly, Category = "Spawning")
+	bool bHasSpawned;
+
+	/** The loaded save says this volume already spawned, it won't spawn the same enemies a second time */
+	UPROPERTY(BlueprintReadOnly, Category = "Spawning")
+	bool bSpawnedInLoadedSave;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -48,4 +62,10 @@ public:
 
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Spawning")
 	void SpawnOurActor(UClass* ToSpawn, const FVector& Location);
+
+	void PrewarmEnemyPool();
+
+	/** Add Count enemies of ToSpawn at random points in the box as background horde agents */
+	UFUNCTION(BlueprintCallable, Category = "Spawning")
+	void SpawnHorde(UClass* ToSpawn, int32 Count);
 };
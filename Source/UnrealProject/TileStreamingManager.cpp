@@ -0,0 +1,275 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileStreamingManager.h"
+#include "WorldManagers.h"
+#include "GameFramework/Character.h"
+#include "Engine/Level.h"
+#include "Engine/LevelBounds.h"
+#include "Engine/LevelStreaming.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/PackageName.h"
+
+/** Reads the grid position out of a name ending in _x<X>_y<Y> */
+static bool ParseTileCoordinates(const FString& LevelName, FIntPoint& OutCoordinates)
+{
+	const int32 XIndex = LevelName.Find(TEXT("_x"), ESearchCase::IgnoreCase, ESearchDir::FromEnd);
+	const int32 YIndex = LevelName.Find(TEXT("_y"), ESearchCase::IgnoreCase, ESearchDir::FromEnd);
+	if (XIndex == INDEX_NONE || YIndex <= XIndex) { return false; }
+
+	const FString X = LevelName.Mid(XIndex + 2, YIndex - XIndex - 2);
+	const FString Y = LevelName.Mid(YIndex + 2);
+	if (X.IsEmpty() || Y.IsEmpty() || !X.IsNumeric() || !Y.IsNumeric()) { return false; }
+
+	OutCoordinates = FIntPoint(FCString::Atoi(*X), FCString::Atoi(*Y));
+	return true;
+}
+
+// Sets default values
+ATileStreamingManager::ATileStreamingManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	TileSize = 50400.f;
+	TileOrigin = FVector::ZeroVector;
+	LoadRadius = 30000.f;
+	UnloadRadius = 40000.f;
+	PrefetchSeconds = 3.f;
+	MemoryBudgetMB = 1024.f;
+	UpdateInterval = 0.25f;
+
+	NumLoadedTiles = 0;
+	NumPendingTiles = 0;
+	ResidentMemoryMB = 0.f;
+	LastTileLoadMs = 0.f;
+	AverageTileLoadMs = 0.f;
+	NumBudgetEvictions = 0;
+
+	TimeSinceUpdate = 0.f;
+	NumLoadsMeasured = 0;
+	TotalLoadMs = 0.0;
+}
+
+ATileStreamingManager* ATileStreamingManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<ATileStreamingManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called when the game starts or when spawned
+void ATileStreamingManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	GatherTiles();
+
+	// Nothing to stream in a map that isn't tiled
+	if (Tiles.Num() == 0)
+	{
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	UpdateStreaming();
+}
+
+// Called every frame
+void ATileStreamingManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	PollPendingTiles();
+
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < UpdateInterval) { return; }
+	TimeSinceUpdate = 0.f;
+
+	UpdateStreaming();
+}
+
+void ATileStreamingManager::GatherTiles()
+{
+	Tiles.Reset();
+
+	// World composition streams its own tiles by distance and would undo anything set here
+	UWorld* World = GetWorld();
+	if (World->WorldComposition) { return; }
+
+	for (ULevelStreaming* LevelStreaming : World->GetStreamingLevels())
+	{
+		if (LevelStreaming == nullptr) { continue; }
+
+		FIntPoint Coordinates;
+		if (!ParseTileCoordinates(FPackageName::GetShortName(LevelStreaming->GetWorldAssetPackageName()), Coordinates)) { continue; }
+
+		FStreamingTile& Tile = Tiles.AddDefaulted_GetRef();
+		Tile.LevelStreaming = LevelStreaming;
+		Tile.Coordinates = Coordinates;
+
+		const FVector Min = TileOrigin + FVector(Coordinates.X * TileSize, Coordinates.Y * TileSize, 0.f);
+		Tile.Bounds = FBox(Min, Min + FVector(TileSize, TileSize, 0.f));
+
+		// Tiles set to load with the persistent level are resident from the start
+		if (IsTileLoaded(Tile))
+		{
+			Tile.ResidentBytes = MeasureTileMemory(LevelStreaming->GetLoadedLevel());
+		}
+	}
+}
+
+void ATileStreamingManager::UpdateStreaming()
+{
+	ACharacter* Player = UGameplayStatics::GetPlayerCharacter(this, 0);
+	if (Player == nullptr) { return; }
+
+	const FVector Location = Player->GetActorLocation();
+	const FVector PredictedLocation = Location + Player->GetVelocity() * PrefetchSeconds;
+
+	// Tiles never loaded yet are assumed to cost what the measured ones do on average
+	int64 MeasuredBytes = 0;
+	int32 NumMeasured = 0;
+	for (const FStreamingTile& Tile : Tiles)
+	{
+		if (Tile.ResidentBytes > 0)
+		{
+			MeasuredBytes += Tile.ResidentBytes;
+			++NumMeasured;
+		}
+	}
+	const int64 EstimatedBytes = NumMeasured > 0 ? MeasuredBytes / NumMeasured : 0;
+
+	// Nearest first, so the budget goes to the tiles needed soonest
+	TArray<TPair<float, int32>> Order;
+	Order.Reserve(Tiles.Num());
+	for (int32 i = 0; i < Tiles.Num(); i++)
+	{
+		const float Distance = FMath::Min(DistanceToTile(Tiles[i], Location), DistanceToTile(Tiles[i], PredictedLocation));
+		Order.Emplace(Distance, i);
+	}
+	Order.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+
+	const int64 BudgetBytes = (int64)(MemoryBudgetMB * 1024.f * 1024.f);
+	int64 UsedBytes = 0;
+	for (const TPair<float, int32>& Entry : Order)
+	{
+		FStreamingTile& Tile = Tiles[Entry.Value];
+		const bool bLoaded = Tile.bLoadPending || IsTileLoaded(Tile);
+
+		if (Entry.Key > (bLoaded ? UnloadRadius : LoadRadius))
+		{
+			if (bLoaded)
+			{
+				RequestUnload(Tile);
+			}
+			continue;
+		}
+
+		// The tile the player stands on is kept whatever it costs
+		const int64 TileBytes = Tile.ResidentBytes > 0 ? Tile.ResidentBytes : EstimatedBytes;
+		if (Entry.Key > 0.f && UsedBytes + TileBytes > BudgetBytes)
+		{
+			if (bLoaded)
+			{
+				RequestUnload(Tile);
+				++NumBudgetEvictions;
+			}
+			continue;
+		}
+
+		UsedBytes += TileBytes;
+		if (!bLoaded)
+		{
+			RequestLoad(Tile);
+		}
+	}
+
+	NumLoadedTiles = 0;
+	NumPendingTiles = 0;
+	int64 ResidentBytes = 0;
+	for (const FStreamingTile& Tile : Tiles)
+	{
+		if (Tile.bLoadPending)
+		{
+			++NumPendingTiles;
+		}
+		else if (IsTileLoaded(Tile))
+		{
+			++NumLoadedTiles;
+			ResidentBytes += Tile.ResidentBytes;
+		}
+	}
+	ResidentMemoryMB = (float)ResidentBytes / (1024.f * 1024.f);
+}
+
+void ATileStreamingManager::PollPendingTiles()
+{
+	const double Now = FPlatformTime::Seconds();
+	for (FStreamingTile& Tile : Tiles)
+	{
+		if (!Tile.bLoadPending || !IsTileLoaded(Tile)) { continue; }
+
+		Tile.bLoadPending = false;
+		Tile.LoadTimeMs = (float)((Now - Tile.RequestTime) * 1000.0);
+
+		LastTileLoadMs = Tile.LoadTimeMs;
+		TotalLoadMs += Tile.LoadTimeMs;
+		++NumLoadsMeasured;
+		AverageTileLoadMs = (float)(TotalLoadMs / NumLoadsMeasured);
+
+		ULevel* Level = Tile.LevelStreaming->GetLoadedLevel();
+		Tile.ResidentBytes = MeasureTileMemory(Level);
+
+		// The grid cell was a guess, the loaded level knows where its actors really are
+		const FBox LevelBounds = ALevelBounds::CalculateLevelBounds(Level);
+		if (LevelBounds.IsValid)
+		{
+			Tile.Bounds = LevelBounds;
+		}
+	}
+}
+
+void ATileStreamingManager::RequestLoad(FStreamingTile& Tile)
+{
+	Tile.LevelStreaming->SetShouldBeLoaded(true);
+	Tile.LevelStreaming->SetShouldBeVisible(true);
+
+	Tile.bLoadPending = true;
+	Tile.RequestTime = FPlatformTime::Seconds();
+}
+
+void ATileStreamingManager::RequestUnload(FStreamingTile& Tile)
+{
+	Tile.LevelStreaming->SetShouldBeVisible(false);
+	Tile.LevelStreaming->SetShouldBeLoaded(false);
+
+	Tile.bLoadPending = false;
+}
+
+bool ATileStreamingManager::IsTileLoaded(const FStreamingTile& Tile)
+{
+	return Tile.LevelStreaming && Tile.LevelStreaming->IsLevelVisible();
+}
+
+int64 ATileStreamingManager::MeasureTileMemory(ULevel* Level)
+{
+	if (Level == nullptr) { return 0; }
+
+	int64 Bytes = 0;
+	for (AActor* Actor : Level->Actors)
+	{
+		if (Actor == nullptr) { continue; }
+
+		for (UActorComponent* Component : Actor->GetComponents())
+		{
+			Bytes += Component->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		}
+	}
+	return Bytes;
+}
+
+float ATileStreamingManager::DistanceToTile(const FStreamingTile& Tile, const FVector& Location)
+{
+	const float DX = FMath::Max3(Tile.Bounds.Min.X - Location.X, 0.f, Location.X - Tile.Bounds.Max.X);
+	const float DY = FMath::Max3(Tile.Bounds.Min.Y - Location.Y, 0.f, Location.Y - Tile.Bounds.Max.Y);
+	return FMath::Sqrt(DX * DX + DY * DY);
+}
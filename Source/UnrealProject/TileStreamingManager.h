@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TileStreamingManager.generated.h"
+
+/** One landscape tile sublevel and what streaming it has cost */
+USTRUCT(BlueprintType)
+struct FStreamingTile
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	class ULevelStreaming* LevelStreaming;
+
+	/** Grid position taken from the _x_y suffix of the sublevel's name */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tile")
+	FIntPoint Coordinates;
+
+	/** Grid cell until the tile has been loaded once, its measured bounds after */
+	FBox Bounds;
+
+	/** Set while a load has been requested and the level isn't visible yet */
+	bool bLoadPending;
+
+	double RequestTime;
+
+	/** Time of the last load, request to visible */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tile")
+	float LoadTimeMs;
+
+	/** Estimated memory of the tile's components, measured when it was last loaded */
+	UPROPERTY(VisibleAnywhere, Category = "Tile")
+	int64 ResidentBytes;
+
+	FStreamingTile()
+	{
+		LevelStreaming = nullptr;
+		Coordinates = FIntPoint::ZeroValue;
+		Bounds = FBox(ForceInit);
+		bLoadPending = false;
+		RequestTime = 0.0;
+		LoadTimeMs = 0.f;
+		ResidentBytes = 0;
+	}
+};
+
+/**
+ * Streams the landscape tiles of a tiled map in and out around the player.
+ * Tiles are the map's sublevels named with a _x<X>_y<Y> suffix, as the tiled landscape import names them.
+ * Tiles within LoadRadius of the player, or of where the player's velocity takes them in PrefetchSeconds, are loaded
+ * nearest first while the loaded tiles fit MemoryBudgetMB, and tiles beyond UnloadRadius are unloaded.
+ * Maps run by world composition are left to it.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API ATileStreamingManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ATileStreamingManager();
+
+	static ATileStreamingManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	/** World size of one grid cell */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tile Streaming")
+	float TileSize;
+
+	/** World position of the corner of tile x0_y0 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tile Streaming")
+	FVector TileOrigin;
+
+	/** Tiles closer than this to the player or the predicted position are loaded */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tile Streaming")
+	float LoadRadius;
+
+	/** Tiles further than this from both are unloaded, kept above LoadRadius so tiles don't flicker at the edge */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tile Streaming")
+	float UnloadRadius;
+
+	/** How far ahead the player's velocity is followed to prefetch tiles */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tile Streaming")
+	float PrefetchSeconds;
+
+	/** Memory the loaded tiles may take, the furthest are dropped to stay under it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tile Streaming")
+	float MemoryBudgetMB;
+
+	/** Seconds between streaming decisions, pending loads are checked every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tile Streaming")
+	float UpdateInterval;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tile Streaming | Stats")
+	TArray<FStreamingTile> Tiles;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tile Streaming | Stats")
+	int32 NumLoadedTiles;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tile Streaming | Stats")
+	int32 NumPendingTiles;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tile Streaming | Stats")
+	float ResidentMemoryMB;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tile Streaming | Stats")
+	float LastTileLoadMs;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tile Streaming | Stats")
+	float AverageTileLoadMs;
+
+	/** Tiles unloaded or not loaded because of the memory budget */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tile Streaming | Stats")
+	int32 NumBudgetEvictions;
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+public:
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+private:
+	void GatherTiles();
+
+	void UpdateStreaming();
+
+	/** Finish pending loads whose level became visible */
+	void PollPendingTiles();
+
+	void RequestLoad(FStreamingTile& Tile);
+	void RequestUnload(FStreamingTile& Tile);
+
+	static bool IsTileLoaded(const FStreamingTile& Tile);
+
+	/** Component memory of a loaded tile, shared assets are counted for every tile using them */
+	static int64 MeasureTileMemory(ULevel* Level);
+
+	/** Horizontal distance from Location to the tile, 0 inside it */
+	static float DistanceToTile(const FStreamingTile& Tile, const FVector& Location);
+
+	float TimeSinceUpdate;
+
+	int32 NumLoadsMeasured;
+	double TotalLoadMs;
+};
@@ -4,12 +4,16 @@
 #include "Weapon.h"
 #include "MainCharacter.h"
 #include "Enemy.h"
+#include "FXPool.h"
+#include "DamageQueue.h"
+#include "AssetStreamingSubsystem.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/BoxComponent.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "Sound/SoundCue.h"
 #include "Kismet/GameplayStatics.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "Particles/ParticleSystem.h"
 
 AWeapon::AWeapon()
 {
@@ -23,6 +27,8 @@ AWeapon::AWeapon()
 
 	Damage = 25.f;
 
+	SwingId = INDEX_NONE;
+
 	// Initialize Enum
 	WeaponState = EWeaponState::EWS_Pickup;
 }
@@ -31,13 +37,13 @@ void AWeapon::BeginPlay()
 {
 	Super::BeginPlay();
 
-	CombatCollision->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::CombatOnOverlapBegin);
-	CombatCollision->OnComponentEndOverlap.AddDynamic(this, &AWeapon::CombatOnOverlapEnd);
-
+	// CombatCollision only gives the melee trace manager its shape, it never collides itself
 	CombatCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	CombatCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
 	CombatCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	CombatCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+
+	WeaponSocket.Init(SkeletalMesh, FName("WeaponSocket"));
 }
 
 void AWeapon::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -82,14 +88,15 @@ void AWeapon::Equip(AMainCharacter* Char)
 		if (RightHandSocket)
 		{
 			RightHandSocket->AttachActor(this, Char->GetMesh());
-			bRotate = false;
+			SetRotate(false);
 
 			Char->SetEquippedWeapon(this);
 			Char->SetActiveOverlappingItem(nullptr);
 		}
-		if (OnEquipSound)
+		USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, OnEquipSound);
+		if (Sound)
 		{
-			UGameplayStatics::PlaySound2D(this, OnEquipSound);
+			UGameplayStatics::PlaySound2D(this, Sound);
 		}
 		if (!bWeaponParticles)
 		{
@@ -108,19 +115,28 @@ void AWeapon::Unequip(AMainCharacter* Char)
 		if (MeleeWeaponSocket)
 		{
 			MeleeWeaponSocket->AttachActor(this, Char->GetMesh());
-			bRotate = false;
+			SetRotate(false);
 
 			Char->SetEquippedWeapon(nullptr);
 			Char->UnequippedWeapon = this;
 			Char->SetActiveOverlappingItem(nullptr);
 		}
-		if (OnEquipSound)
+		USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, OnEquipSound);
+		if (Sound)
 		{
-			UGameplayStatics::PlaySound2D(this, OnEquipSound);
+			UGameplayStatics::PlaySound2D(this, Sound);
 		}
 	}
 }
 
+void AWeapon::GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	Super::GetPreloadAssets(OutAssets);
+
+	OutAssets.Add(OnEquipSound.ToSoftObjectPath());
+	OutAssets.Add(SwingSound.ToSoftObjectPath());
+}
+
 void AWeapon::CombatOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
 	if (OtherActor)
@@ -128,22 +144,25 @@ void AWeapon::CombatOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AAc
 		AEnemy* Enemy = Cast<AEnemy>(OtherActor);
 		if (Enemy)
 		{
-			if (Enemy->HitParticles)
+			UParticleSystem* Particles = UAssetStreamingSubsystem::Resolve(this, Enemy->HitParticles);
+			if (Particles && WeaponSocket.IsValid())
 			{
-				const USkeletalMeshSocket* WeaponSocket = SkeletalMesh->GetSocketByName("WeaponSocket");
-				if (WeaponSocket)
+				FVector SocketLocation = WeaponSocket.GetLocation(SkeletalMesh);
+				AFXPool* FXPool = AFXPool::Get(this);
+				if (FXPool)
 				{
-					FVector SocketLocation = WeaponSocket->GetSocketLocation(SkeletalMesh);
-					UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Enemy->HitParticles, SocketLocation, FRotator(0.f), false);
+					FXPool->SpawnEffect(Particles, SocketLocation, FRotator(0.f));
 				}
 			}
-			if (Enemy->HitSound)
+			USoundCue* Sound = UAssetStreamingSubsystem::Resolve(this, Enemy->HitSound);
+			if (Sound)
 			{
-				UGameplayStatics::PlaySound2D(this, Enemy->HitSound);
+				UGameplayStatics::PlaySound2D(this, Sound);
 			}
-			if (DamageTypeClass)
+			ADamageQueue* DamageQueue = ADamageQueue::Get(this);
+			if (DamageQueue && DamageTypeClass)
 			{
-				UGameplayStatics::ApplyDamage(Enemy, Damage, WeaponInstigator, this, DamageTypeClass);
+				DamageQueue->QueueDamage(Enemy, Damage, WeaponInstigator, this, DamageTypeClass, SweepResult.ImpactPoint);
 			}
 		}
 	}
@@ -153,12 +172,34 @@ void AWeapon::CombatOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActo
 {
 }
 
+void AWeapon::OnMeleeHit(const FHitResult& Hit)
+{
+	CombatOnOverlapBegin(CombatCollision, Hit.GetActor(), Hit.GetComponent(), Hit.Item, true, Hit);
+}
+
 void AWeapon::ActivateCollision()
 {
-	CombatCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	AMeleeTraceManager* MeleeTraceManager = AMeleeTraceManager::Get(this);
+	if (MeleeTraceManager)
+	{
+		DeactivateCollision();
+
+		TArray<AActor*> IgnoredActors;
+		IgnoredActors.Add(this);
+		if (GetAttachParentActor())
+		{
+			IgnoredActors.Add(GetAttachParentActor());
+		}
+		SwingId = MeleeTraceManager->BeginSwing(CombatCollision, IgnoredActors, FOnMeleeHit::CreateUObject(this, &AWeapon::OnMeleeHit));
+	}
 }
 
 void AWeapon::DeactivateCollision()
 {
-	CombatCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AMeleeTraceManager* MeleeTraceManager = AMeleeTraceManager::Get(this, false);
+	if (MeleeTraceManager && SwingId != INDEX_NONE)
+	{
+		MeleeTraceManager->EndSwing(SwingId);
+	}
+	SwingId = INDEX_NONE;
 }
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Item.h"
+#include "MeleeTraceManager.h"
 #include "Weapon.generated.h"
 
 UENUM(BlueprintType)
@@ -31,11 +32,11 @@ public:
 
 	/** Sound played when equipped */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Sound")
-	class USoundCue* OnEquipSound;
+	TSoftObjectPtr<class USoundCue> OnEquipSound;
 
 	/** Sound played when swung */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Sound")
-	USoundCue* SwingSound;
+	TSoftObjectPtr<USoundCue> SwingSound;
 
 	/** Whether particles are still emitted by weapon after being equipped*/
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Particles")
@@ -58,6 +59,12 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item | Combat")
 	AController* WeaponInstigator;
 
+	/** Swing opened by ActivateCollision in the melee trace manager */
+	int32 SwingId;
+
+	/** Where hit particles spawn */
+	FMeleeSocket WeaponSocket;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -67,6 +74,8 @@ public:
 	virtual void OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult) override;
 	virtual void OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex) override;
 
+	virtual void GetPreloadAssets(TArray<FSoftObjectPath>& OutAssets) const override;
+
 	void Equip(class AMainCharacter* Char);
 	void Unequip(class AMainCharacter* Char);
 
@@ -78,6 +87,9 @@ public:
 	UFUNCTION()
 	void CombatOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
+	/** Hit reported by the melee trace manager, forwarded to CombatOnOverlapBegin */
+	void OnMeleeHit(const FHitResult& Hit);
+
 	UFUNCTION(BlueprintCallable)
 	void ActivateCollision();
 	UFUNCTION(BlueprintCallable)
@@ -0,0 +1,11 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponRegistry.h"
+#include "Weapon.h"
+
+TSoftClassPtr<AWeapon> UWeaponRegistry::FindWeapon(FName WeaponName) const
+{
+	const TSoftClassPtr<AWeapon>* WeaponClass = Weapons.Find(WeaponName);
+	return WeaponClass ? *WeaponClass : TSoftClassPtr<AWeapon>();
+}
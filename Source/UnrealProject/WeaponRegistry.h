@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "WeaponRegistry.generated.h"
+
+/**
+ * Every weapon a save can refer to, by the Name it is saved under.
+ * The classes are soft references, a weapon class is only loaded once a save or level transition asks for it.
+ */
+UCLASS(BlueprintType)
+class UNREALPROJECT_API UWeaponRegistry : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditDefaultsOnly, Category = "Weapons")
+	TMap<FName, TSoftClassPtr<class AWeapon>> Weapons;
+
+	/** Class saved under WeaponName, null if the registry has none */
+	TSoftClassPtr<AWeapon> FindWeapon(FName WeaponName) const;
+};
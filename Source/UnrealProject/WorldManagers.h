@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+/**
+ * Finds the single manager actor of type T in the world of WorldContextObject.
+ * Managers are spawned on first use, one per world, so they never have to be placed in a map.
+ * Pass bSpawnIfMissing = false from EndPlay/teardown paths so nothing is spawned while the world is going away.
+ */
+template<class T>
+T* GetWorldManager(const UObject* WorldContextObject, bool bSpawnIfMissing = true)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	if (World == nullptr || !World->IsGameWorld()) { return nullptr; }
+
+	// Managers are looked up from per-frame code, so remember them per world
+	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<T>> Managers;
+
+	TWeakObjectPtr<T>* Cached = Managers.Find(World);
+	if (Cached && Cached->IsValid() && !(*Cached)->IsPendingKill())
+	{
+		return Cached->Get();
+	}
+
+	T* Manager = nullptr;
+	for (TActorIterator<T> It(World); It; ++It)
+	{
+		if (!It->IsPendingKill())
+		{
+			Manager = *It;
+			break;
+		}
+	}
+
+	if (Manager == nullptr)
+	{
+		if (!bSpawnIfMissing || World->bIsTearingDown) { return nullptr; }
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		Manager = World->SpawnActor<T>(T::StaticClass(), FTransform::Identity, SpawnParams);
+	}
+
+	for (auto It = Managers.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	Managers.Add(World, Manager);
+
+	return Manager;
+}
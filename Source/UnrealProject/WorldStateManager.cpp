@@ -0,0 +1,259 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WorldStateManager.h"
+#include "WorldManagers.h"
+#include "FirstSaveGame.h"
+#include "SaveGameSubsystem.h"
+#include "MainCharacter.h"
+#include "Pickup.h"
+#include "Enemy.h"
+#include "FloorSwitch.h"
+#include "SpawnVolume.h"
+#include "FloatingPlatform.h"
+#include "Kismet/GameplayStatics.h"
+
+// Sets default values
+AWorldStateManager::AWorldStateManager()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = false;
+
+	NumTrackedActors = 0;
+	NumChangedActors = 0;
+	SaveSizeBytes = 0;
+
+	BaselineChecksum = 0;
+	PlatformTimeOffset = 0.f;
+	NumPlatforms = 0;
+	bDirty = false;
+}
+
+AWorldStateManager* AWorldStateManager::Get(const UObject* WorldContextObject, bool bSpawnIfMissing)
+{
+	return GetWorldManager<AWorldStateManager>(WorldContextObject, bSpawnIfMissing);
+}
+
+// Called when the game starts or when spawned
+void AWorldStateManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BuildBaseline();
+}
+
+void AWorldStateManager::MarkChanged(AActor* Actor)
+{
+	const int32* Id = StableIds.Find(Actor);
+	if (Id == nullptr || ChangedBits[*Id]) { return; }
+
+	ChangedBits[*Id] = true;
+	++NumChangedActors;
+	bDirty = true;
+	ChangedBitsSnapshot.Reset();
+}
+
+bool AWorldStateManager::IsChanged(const AActor* Actor) const
+{
+	const int32* Id = StableIds.Find(Actor);
+	return Id && ChangedBits[*Id];
+}
+
+void AWorldStateManager::SaveWorldState(const FString& PlayerName)
+{
+	if (!bDirty && NumPlatforms == 0) { return; }
+
+	UWorldStateSaveGame* SaveGameInstance = Cast<UWorldStateSaveGame>(UGameplayStatics::CreateSaveGameObject(UWorldStateSaveGame::StaticClass()));
+	SaveGameInstance->LevelName = LevelName;
+	SaveGameInstance->BaselineChecksum = BaselineChecksum;
+	SaveGameInstance->PlatformTime = AFloatingPlatform::GetMotionTime(GetWorld());
+	SaveGameInstance->ChangedBits.SetNumZeroed((ChangedBits.Num() + 7) / 8);
+	for (TConstSetBitIterator<> It(ChangedBits); It; ++It)
+	{
+		SaveGameInstance->ChangedBits[It.GetIndex() / 8] |= 1 << (It.GetIndex() % 8);
+	}
+	SaveSizeBytes = SaveGameInstance->ChangedBits.Num() + sizeof(SaveGameInstance->PlatformTime);
+
+	const FString SlotName = GetSlotName(PlayerName, LevelName);
+	USaveGameSubsystem* SaveGameSubsystem = USaveGameSubsystem::Get(this);
+	if (SaveGameSubsystem)
+	{
+		SaveGameSubsystem->SaveGameAsync(SaveGameInstance, SlotName);
+	}
+	else
+	{
+		UGameplayStatics::SaveGameToSlot(SaveGameInstance, SlotName, 0);
+	}
+
+	bDirty = false;
+}
+
+TSharedRef<const TBitArray<>> AWorldStateManager::GetChangedBitsSnapshot()
+{
+	if (!ChangedBitsSnapshot.IsValid())
+	{
+		ChangedBitsSnapshot = MakeShared<const TBitArray<>>(ChangedBits);
+	}
+	return ChangedBitsSnapshot.ToSharedRef();
+}
+
+void AWorldStateManager::RestoreChangedBits(const TBitArray<>& Bits)
+{
+	if (Bits.Num() != ChangedBits.Num()) { return; }
+
+	for (int32 Id = 0; Id < ChangedBits.Num(); Id++)
+	{
+		if (Bits[Id] == ChangedBits[Id]) { continue; }
+
+		AActor* Actor = TrackedActors[Id];
+		if (Bits[Id])
+		{
+			ChangedBits[Id] = true;
+			++NumChangedActors;
+			if (IsValid(Actor))
+			{
+				ApplyChange(Actor);
+			}
+		}
+		else if (AFloorSwitch* FloorSwitch = Cast<AFloorSwitch>(Actor))
+		{
+			ChangedBits[Id] = false;
+			--NumChangedActors;
+			FloorSwitch->bHasBeenTriggered = false;
+			if (FloorSwitch->HasActorBegunPlay())
+			{
+				FloorSwitch->LowerDoor();
+			}
+		}
+		else if (ASpawnVolume* SpawnVolume = Cast<ASpawnVolume>(Actor))
+		{
+			ChangedBits[Id] = false;
+			--NumChangedActors;
+			SpawnVolume->bHasSpawned = false;
+			SpawnVolume->bSpawnedInLoadedSave = false;
+		}
+	}
+
+	bDirty = true;
+	ChangedBitsSnapshot.Reset();
+}
+
+FString AWorldStateManager::GetSlotName(const FString& PlayerName, const FString& LevelName)
+{
+	return PlayerName + TEXT("_") + LevelName;
+}
+
+void AWorldStateManager::BuildBaseline()
+{
+	UWorld* World = GetWorld();
+	LevelName = World->GetMapName();
+	LevelName.RemoveFromStart(World->StreamingLevelsPrefix);
+
+	TArray<TPair<FString, AActor*>> Placed;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (IsTrackedActor(*It))
+		{
+			Placed.Emplace(UWorld::RemovePIEPrefix(It->GetPathName()), *It);
+		}
+	}
+
+	// Placed actors keep their path every time the map loads, so sorting by it gives the same IDs each time
+	Placed.Sort([](const TPair<FString, AActor*>& A, const TPair<FString, AActor*>& B) { return A.Key < B.Key; });
+
+	NumPlatforms = 0;
+	for (TActorIterator<AFloatingPlatform> It(World); It; ++It)
+	{
+		++NumPlatforms;
+	}
+
+	BaselineChecksum = 0;
+	TrackedActors.Reset(Placed.Num());
+	StableIds.Reset();
+	for (const TPair<FString, AActor*>& Actor : Placed)
+	{
+		BaselineChecksum = FCrc::StrCrc32(*Actor.Key, BaselineChecksum);
+		StableIds.Add(Actor.Value, TrackedActors.Add(Actor.Value));
+	}
+
+	ChangedBits.Init(false, TrackedActors.Num());
+	NumTrackedActors = TrackedActors.Num();
+	NumChangedActors = 0;
+}
+
+void AWorldStateManager::LoadWorldState(const FString& PlayerName)
+{
+	const FString SlotName = GetSlotName(PlayerName, LevelName);
+
+	UWorldStateSaveGame* LoadGameInstance = nullptr;
+	USaveGameSubsystem* SaveGameSubsystem = USaveGameSubsystem::Get(this);
+	if (SaveGameSubsystem)
+	{
+		LoadGameInstance = Cast<UWorldStateSaveGame>(SaveGameSubsystem->LoadGame(SlotName, 0));
+	}
+	else if (UGameplayStatics::DoesSaveGameExist(SlotName, 0))
+	{
+		LoadGameInstance = Cast<UWorldStateSaveGame>(UGameplayStatics::LoadGameFromSlot(SlotName, 0));
+	}
+
+	// The IDs only mean something for the layout they were saved against
+	if (LoadGameInstance == nullptr || LoadGameInstance->BaselineChecksum != BaselineChecksum) { return; }
+
+	SaveSizeBytes = LoadGameInstance->ChangedBits.Num() + sizeof(LoadGameInstance->PlatformTime);
+
+	TBitArray<> Bits(false, TrackedActors.Num());
+	for (int32 Id = 0; Id < TrackedActors.Num(); Id++)
+	{
+		const int32 Byte = Id / 8;
+		if (!LoadGameInstance->ChangedBits.IsValidIndex(Byte)) { break; }
+		Bits[Id] = (LoadGameInstance->ChangedBits[Byte] & (1 << (Id % 8))) != 0;
+	}
+	RestoreChangedBits(Bits);
+
+	// Platforms carry on from where they were when the save was written
+	PlatformTimeOffset += LoadGameInstance->PlatformTime - AFloatingPlatform::GetMotionTime(GetWorld());
+	for (TActorIterator<AFloatingPlatform> It(GetWorld()); It; ++It)
+	{
+		It->SetActorLocation(It->GetLocationAtTime(LoadGameInstance->PlatformTime));
+	}
+}
+
+void AWorldStateManager::ApplyChange(AActor* Actor)
+{
+	if (APickup* Pickup = Cast<APickup>(Actor))
+	{
+		AMainCharacter* MainCharacter = Cast<AMainCharacter>(UGameplayStatics::GetPlayerCharacter(this, 0));
+		if (MainCharacter)
+		{
+			MainCharacter->PickupLocations.Add(Pickup->GetActorLocation());
+		}
+		Pickup->Destroy();
+	}
+	else if (AEnemy* Enemy = Cast<AEnemy>(Actor))
+	{
+		Enemy->Destroy();
+	}
+	else if (AFloorSwitch* FloorSwitch = Cast<AFloorSwitch>(Actor))
+	{
+		FloorSwitch->bHasBeenTriggered = true;
+
+		// A switch that hasn't begun play doesn't know where its door starts yet, it opens it itself in BeginPlay
+		if (FloorSwitch->HasActorBegunPlay())
+		{
+			FloorSwitch->RaiseDoor();
+		}
+	}
+	else if (ASpawnVolume* SpawnVolume = Cast<ASpawnVolume>(Actor))
+	{
+		SpawnVolume->bHasSpawned = true;
+		SpawnVolume->bSpawnedInLoadedSave = true;
+	}
+}
+
+bool AWorldStateManager::IsTrackedActor(const AActor* Actor)
+{
+	// Startup actors are the ones loaded with the map, anything spawned at runtime has no stable ID
+	if (Actor == nullptr || !Actor->IsNetStartupActor()) { return false; }
+
+	return Actor->IsA<APickup>() || Actor->IsA<AEnemy>() || Actor->IsA<AFloorSwitch>() || Actor->IsA<ASpawnVolume>();
+}
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "WorldStateManager.generated.h"
+
+/**
+ * Persists what happened to the level's placed pickups, enemies, floor switches and spawn volumes.
+ * Each placed actor gets a stable ID from its sorted name when the level starts, and the save only holds
+ * one bit per ID telling whether the actor changed from the level's baseline, so its size depends on the level
+ * and not on how long the playthrough is. Every level saves to its own slot and only when something in it changed.
+ * Floating platforms all run off one clock, so their state is a single saved time.
+ * The saved state is only applied when a save is loaded, a fresh level always starts from its baseline.
+ */
+UCLASS(NotPlaceable)
+class UNREALPROJECT_API AWorldStateManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AWorldStateManager();
+
+	static AWorldStateManager* Get(const UObject* WorldContextObject, bool bSpawnIfMissing = true);
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "World State | Stats")
+	int32 NumTrackedActors;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "World State | Stats")
+	int32 NumChangedActors;
+
+	/** Size of the level's saved state */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "World State | Stats")
+	int32 SaveSizeBytes;
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+public:
+	/** Record that a placed actor left its baseline state, runtime spawned actors are ignored */
+	void MarkChanged(AActor* Actor);
+
+	bool IsChanged(const AActor* Actor) const;
+
+	/** Queue the level's state for writing if it changed since the last save */
+	void SaveWorldState(const FString& PlayerName);
+
+	/** Put the level in the state PlayerName's save holds for it, changes the save doesn't have are rewound like RestoreChangedBits */
+	void LoadWorldState(const FString& PlayerName);
+
+	/** Copy of the changed bits, shared by every caller until the next change */
+	TSharedRef<const TBitArray<>> GetChangedBitsSnapshot();
+
+	/**
+	 * Rewind to an earlier snapshot. Switch and spawn volume flags set since are cleared again,
+	 * pickups and enemies removed since can't be brought back and stay changed.
+	 */
+	void RestoreChangedBits(const TBitArray<>& Bits);
+
+	FORCEINLINE uint32 GetBaselineChecksum() const { return BaselineChecksum; }
+	FORCEINLINE const FString& GetLevelName() const { return LevelName; }
+
+	/** Added to the world time floating platforms are evaluated at, moves them to where a loaded save had them */
+	FORCEINLINE float GetPlatformTimeOffset() const { return PlatformTimeOffset; }
+
+	static FString GetSlotName(const FString& PlayerName, const FString& LevelName);
+
+private:
+	void BuildBaseline();
+
+	/** Put a changed actor in the state the save describes */
+	void ApplyChange(AActor* Actor);
+
+	static bool IsTrackedActor(const AActor* Actor);
+
+	/** Tracked actors in stable ID order, destroyed ones are left null */
+	UPROPERTY()
+	TArray<AActor*> TrackedActors;
+
+	TMap<TWeakObjectPtr<const AActor>, int32> StableIds;
+
+	TBitArray<> ChangedBits;
+
+	/** Last handed out snapshot, dropped as soon as ChangedBits differs from it */
+	TSharedPtr<const TBitArray<>> ChangedBitsSnapshot;
+
+	uint32 BaselineChecksum;
+
+	FString LevelName;
+
+	float PlatformTimeOffset;
+
+	/** Floating platforms in the level, their time is saved even when nothing else changed */
+	int32 NumPlatforms;
+
+	bool bDirty;
+};